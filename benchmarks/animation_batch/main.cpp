@@ -0,0 +1,155 @@
+#include "../../include/ldtools/sprite_table.h"
+#include "../../include/ldtools/animation_table.h"
+#include "../../include/ldtools/animation_batch.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+//Compares evaluating animations one entity at a time through
+//animation_table::get with animation_batch, single threaded and split across
+//all cores, checking that all of them pick the same frames.
+
+void generate_tables(const std::string&, const std::string&, std::size_t, std::size_t);
+double measure(const std::function<void()>&);
+
+int main(int argc, char ** argv) {
+
+	try {
+
+		const std::string sprites_path{"animation_batch_sprites.txt"},
+			animations_path{"animation_batch_animations.txt"};
+
+		std::vector<std::size_t> sizes{1000, 10000, 100000};
+		if(argc > 1) {
+
+			sizes={std::stoul(argv[1])};
+		}
+
+		const std::size_t animation_count=200;
+		generate_tables(sprites_path, animations_path, animation_count, 64);
+		const ldtools::sprite_table sprites{sprites_path};
+		const ldtools::animation_table table{sprites, animations_path};
+
+		const ldtools::animation_batch single{table, 1},
+			parallel{table, 0};
+
+		for(auto entities : sizes) {
+
+			std::mt19937 rng(entities);
+			std::uniform_int_distribution<std::size_t> id_distribution(1, animation_count);
+			std::uniform_real_distribution<float> time_distribution(0.f, 30.f),
+				scale_distribution(0.5f, 2.f);
+
+			std::vector<std::size_t> ids(entities), expected(entities), indexes(entities);
+			std::vector<float> times(entities), durations(entities);
+			std::vector<const ldtools::sprite_frame *> frames(entities);
+
+			for(std::size_t i=0; i<entities; i++) {
+
+				ids[i]=id_distribution(rng);
+				times[i]=time_distribution(rng);
+				durations[i]=table.get(ids[i]).get_duration() * scale_distribution(rng);
+			}
+
+			const double per_call_time=measure([&]() {
+
+				for(std::size_t i=0; i<entities; i++) {
+
+					expected[i]=table.get(ids[i]).index_for_time(times[i]);
+				}
+			});
+
+			const double single_time=measure([&]() {single.index_for_time(ids.data(), times.data(), nullptr, entities, indexes.data());});
+			if(indexes!=expected) {
+
+				throw std::runtime_error("batch disagrees with index_for_time");
+			}
+
+			const double parallel_time=measure([&]() {parallel.index_for_time(ids.data(), times.data(), nullptr, entities, indexes.data());});
+			if(indexes!=expected) {
+
+				throw std::runtime_error("threaded batch disagrees with index_for_time");
+			}
+
+			const double frames_time=measure([&]() {single.frames_for_time(ids.data(), times.data(), nullptr, entities, frames.data());});
+
+			//Rescaled durations.
+			single.frames_for_time(ids.data(), times.data(), durations.data(), entities, frames.data());
+			for(std::size_t i=0; i<entities; i++) {
+
+				if(frames[i]!=&table.get(ids[i]).get_for_time(times[i], durations[i]).frame) {
+
+					throw std::runtime_error("batch disagrees with get_for_time");
+				}
+			}
+
+			std::cout<<entities<<" entities"<<std::endl
+				<<"\tper call:\t"<<per_call_time<<" us"<<std::endl
+				<<"\tbatch:\t\t"<<single_time<<" us\t"<<per_call_time / single_time<<"x"<<std::endl
+				<<"\tbatch frames:\t"<<frames_time<<" us\t"<<per_call_time / frames_time<<"x"<<std::endl
+				<<"\tbatch ("<<std::thread::hardware_concurrency()<<" threads):\t"<<parallel_time<<" us\t"<<per_call_time / parallel_time<<"x"<<std::endl;
+		}
+
+		std::remove(sprites_path.c_str());
+		std::remove(animations_path.c_str());
+		return 0;
+	}
+	catch(std::exception& e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
+
+//!Writes a sprite table and animations of up to the given frame count,
+//!with ids starting at 1.
+void generate_tables(
+	const std::string& _sprites_path,
+	const std::string& _animations_path,
+	std::size_t _animations,
+	std::size_t _frames
+) {
+
+	std::ofstream sprites(_sprites_path);
+	for(std::size_t i=0; i<_frames; i++) {
+
+		sprites<<i<<"\t"<<i*16<<"\t0\t16\t16\t0\t0\n";
+	}
+
+	std::ofstream animations(_animations_path);
+	for(std::size_t a=1; a<=_animations; a++) {
+
+		animations<<"*animation_"<<a<<"\n!"<<a<<"\n";
+		for(std::size_t i=0; i<1+(a * 7) % _frames; i++) {
+
+			animations<<10*(1+(a+i)%7)<<"\t"<<(a+i) % _frames<<"\n";
+		}
+	}
+}
+
+//!Returns the best of a few runs in microseconds.
+double measure(
+	const std::function<void()>& _fn
+) {
+
+	double best=0.;
+	for(int i=0; i<5; i++) {
+
+		const auto start=std::chrono::steady_clock::now();
+		_fn();
+		const std::chrono::duration<double, std::micro> elapsed=std::chrono::steady_clock::now()-start;
+
+		if(!i || elapsed.count() < best) {
+
+			best=elapsed.count();
+		}
+	}
+
+	return best;
+}
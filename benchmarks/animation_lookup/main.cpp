@@ -0,0 +1,147 @@
+#include "../../include/ldtools/sprite_table.h"
+#include "../../include/ldtools/animation_table.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+//Compares the linear scan animation::get_for_time used to run with the
+//binary search and the baked tick tables, checking that all of them pick
+//the same frames, rescaled durations included.
+
+void generate_tables(const std::string&, const std::string&, std::size_t);
+std::size_t linear_index(const ldtools::animation&, float, float);
+
+int main(int argc, char ** argv) {
+
+	try {
+
+		const std::string sprites_path{"animation_lookup_sprites.txt"},
+			animations_path{"animation_lookup_animations.txt"};
+
+		std::vector<std::size_t> sizes{8, 64, 512};
+		if(argc > 1) {
+
+			sizes={std::stoul(argv[1])};
+		}
+
+		const std::size_t queries=1000000;
+		const float tick=1.f / 50.f;
+
+		for(auto frames : sizes) {
+
+			generate_tables(sprites_path, animations_path, frames);
+			const ldtools::sprite_table sprites{sprites_path};
+			const ldtools::animation_table animations{sprites, animations_path};
+			const auto& anim=animations.get(1);
+
+			std::mt19937 rng(frames);
+			std::uniform_real_distribution<float> distribution(0.f, anim.get_duration() * 4.f);
+			std::vector<float> times(queries);
+			for(auto& t : times) {
+
+				t=distribution(rng);
+			}
+
+			//Identical results, with the real and with a rescaled duration.
+			for(float total : {anim.get_duration(), anim.get_duration() * 0.37f, anim.get_duration() * 3.f}) {
+
+				for(auto t : times) {
+
+					if(linear_index(anim, t, total)!=anim.index_for_time(t, total)) {
+
+						throw std::runtime_error("binary search disagrees at "+std::to_string(t));
+					}
+				}
+			}
+
+			const ldtools::animation_tick_table baked{anim, tick};
+			for(std::size_t i=0; i<baked.size() * 3; i++) {
+
+				if(baked.index_for_tick(i)!=anim.index_for_time((float)(i % baked.size()) * tick)) {
+
+					throw std::runtime_error("baked table disagrees at tick "+std::to_string(i));
+				}
+			}
+
+			std::size_t sum=0;
+			auto measure=[&sum](auto _fn) {
+
+				const auto start=std::chrono::steady_clock::now();
+				for(std::size_t i=0; i<queries; i++) {
+
+					sum+=_fn(i);
+				}
+
+				const std::chrono::duration<double, std::nano> elapsed=std::chrono::steady_clock::now()-start;
+				return elapsed.count() / queries;
+			};
+
+			const float duration=anim.get_duration();
+			const double linear_time=measure([&](std::size_t _i) {return linear_index(anim, times[_i], duration);}),
+				search_time=measure([&](std::size_t _i) {return anim.index_for_time(times[_i]);}),
+				baked_time=measure([&](std::size_t _i) {return baked.index_for_tick(_i * 7);});
+
+			std::cout<<frames<<" frames"<<std::endl
+				<<"\tlinear scan:\t"<<linear_time<<" ns"<<std::endl
+				<<"\tbinary search:\t"<<search_time<<" ns\t"<<linear_time / search_time<<"x"<<std::endl
+				<<"\tbaked ticks:\t"<<baked_time<<" ns\t"<<linear_time / baked_time<<"x"<<std::endl
+				<<"\t("<<sum<<")"<<std::endl;
+		}
+
+		std::remove(sprites_path.c_str());
+		std::remove(animations_path.c_str());
+		return 0;
+	}
+	catch(std::exception& e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
+
+//!Writes a sprite table and an animation with the given frame count, with
+//!durations that are multiples of 20ms.
+void generate_tables(
+	const std::string& _sprites_path,
+	const std::string& _animations_path,
+	std::size_t _frames
+) {
+
+	std::ofstream sprites(_sprites_path);
+	for(std::size_t i=0; i<_frames; i++) {
+
+		sprites<<i<<"\t"<<i*16<<"\t0\t16\t16\t0\t0\n";
+	}
+
+	std::ofstream animations(_animations_path);
+	animations<<"*benchmark\n!1\n";
+	for(std::size_t i=0; i<_frames; i++) {
+
+		animations<<20*(1+i%5)<<"\t"<<i<<"\n";
+	}
+}
+
+//!The loop animation::index_for_time used before the binary search.
+std::size_t linear_index(
+	const ldtools::animation& _animation,
+	float _t,
+	float _total
+) {
+
+	if(_animation.size()==1) return 0;
+
+	float mult=_total / _animation.get_duration();
+	float transformado=fmod(_t, _total);
+	for(std::size_t i=0; i<_animation.size(); i++) {
+		if(transformado <= _animation.get(i).begin_time * mult) {
+			return i;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,212 @@
+#include "../../include/ldtools/sprite_table.h"
+#include "../../include/ldtools/animation_table.h"
+
+#include <tools/string_utils.h>
+#include <tools/text_reader.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+
+//Compares the line by line algorithm animation_table::load used to run,
+//which timed the whole animation again after each line, with the current
+//single pass loader on files with very long animations.
+
+using old_table=std::map<std::size_t, std::vector<ldtools::animation_line>>;
+
+void generate_tables(const std::string&, const std::string&, std::size_t, std::size_t);
+old_table old_load(const ldtools::sprite_table&, const std::string&);
+double measure(const std::function<std::size_t()>&, std::size_t&);
+
+int main(int argc, char ** argv) {
+
+	try {
+
+		const std::string sprites_path{"animation_table_load_sprites.txt"},
+			animations_path{"animation_table_load_animations.txt"};
+
+		const std::size_t animations=10;
+		std::vector<std::size_t> sizes{1000, 5000, 20000};
+		if(argc > 1) {
+
+			sizes={std::stoul(argv[1])};
+		}
+
+		for(auto frames : sizes) {
+
+			generate_tables(sprites_path, animations_path, animations, frames);
+			const ldtools::sprite_table sprites{sprites_path};
+
+			std::cout<<animations<<" animations of "<<frames<<" frames"<<std::endl;
+
+			std::size_t reference=0, count=0;
+			const double old_time=measure([&]() {return old_load(sprites, animations_path).size();}, reference);
+			std::cout<<"\tline by line:\t"<<old_time<<" ms"<<std::endl;
+
+			ldtools::animation_table table{sprites};
+			const double new_time=measure([&]() {table.load(animations_path); return table.size();}, count);
+			std::cout<<"\tsingle pass:\t"<<new_time<<" ms\t"<<old_time / new_time<<"x"<<std::endl;
+
+			//Make sure both read the same thing.
+			const auto expected=old_load(sprites, animations_path);
+			if(expected.size()!=count || reference!=count) {
+
+				throw std::runtime_error("loaders disagree on size");
+			}
+
+			for(const auto& pair : expected) {
+
+				const auto& anim=table.get(pair.first);
+				if(anim.size()!=pair.second.size()) {
+
+					throw std::runtime_error("loaders disagree on animation "+std::to_string(pair.first));
+				}
+
+				for(std::size_t i=0; i<anim.size(); i++) {
+
+					const auto& a=anim.get(i);
+					const auto& b=pair.second[i];
+					if(a.duration!=b.duration || a.begin_time!=b.begin_time || a.frame_index!=b.frame_index || a.flags!=b.flags) {
+
+						throw std::runtime_error("loaders disagree on animation "+std::to_string(pair.first)+" line "+std::to_string(i));
+					}
+				}
+			}
+		}
+
+		std::remove(sprites_path.c_str());
+		std::remove(animations_path.c_str());
+		return 0;
+	}
+	catch(std::exception& e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
+
+//!Writes a sprite table and animations with the given frame count, with
+//!comments and optional flags.
+void generate_tables(
+	const std::string& _sprites_path,
+	const std::string& _animations_path,
+	std::size_t _animations,
+	std::size_t _frames
+) {
+
+	std::ofstream sprites(_sprites_path);
+	for(std::size_t i=0; i<256; i++) {
+
+		sprites<<i<<"\t"<<i*16<<"\t0\t16\t16\t0\t0\n";
+	}
+
+	std::ofstream animations(_animations_path);
+	for(std::size_t a=1; a<=_animations; a++) {
+
+		animations<<"#animation "<<a<<"\n*animation_"<<a<<"\n!"<<a<<"\n";
+		for(std::size_t i=0; i<_frames; i++) {
+
+			animations<<10*(1+(a+i)%7)<<"\t"<<(a+i)%256;
+			if(i%3) {
+
+				animations<<"\t"<<i%4;
+			}
+
+			animations<<"\n";
+		}
+	}
+}
+
+//!The algorithm animation_table::load used before the single pass: split
+//!each line, time the animation again after each line and copy the
+//!animations into the table.
+old_table old_load(
+	const ldtools::sprite_table& _table,
+	const std::string& _path
+) {
+
+	old_table result;
+	tools::text_reader L(_path, '#');
+
+	if(!L) {
+		throw std::runtime_error("Unable to locate animation file "+_path);
+	}
+
+	auto adjust=[](std::vector<ldtools::animation_line>& _lines) {
+
+		float duration=0;
+		for(auto& l : _lines) {
+			duration+=l.duration;
+			l.begin_time=duration;
+		}
+	};
+
+	std::size_t id=0;
+	std::vector<ldtools::animation_line> lines;
+	while(true) {
+
+		const std::string line=L.read_line();
+		if(L.is_eof()) {
+
+			if(lines.size()) {
+				adjust(lines);
+				result[id]=lines;
+			}
+			break;
+		}
+
+		if('*'==line[0]) {
+
+			if(lines.size()) {
+				adjust(lines);
+				result[id]=lines;
+			}
+			lines.clear();
+		}
+		else if('!'==line[0]) {
+
+			id=std::atoi(tools::explode(line.substr(1), '\t')[0].c_str());
+		}
+		else {
+
+			const auto values=tools::explode(line, '\t');
+			const int index=std::atoi(values[1].c_str());
+			lines.push_back(ldtools::animation_line(
+				(float)std::atoi(values[0].c_str()) / 1000.f,
+				0.0f,
+				_table.get(index),
+				3==values.size() ? std::stoi(values[2]) : 0,
+				index
+			));
+			adjust(lines);
+		}
+	}
+
+	return result;
+}
+
+//!Returns the best of a few runs in milliseconds.
+double measure(
+	const std::function<std::size_t()>& _fn,
+	std::size_t& _count
+) {
+
+	double best=0.;
+	for(int i=0; i<3; i++) {
+
+		const auto start=std::chrono::steady_clock::now();
+		_count=_fn();
+		const std::chrono::duration<double, std::milli> elapsed=std::chrono::steady_clock::now()-start;
+
+		if(!i || elapsed.count() < best) {
+
+			best=elapsed.count();
+		}
+	}
+
+	return best;
+}
@@ -0,0 +1,184 @@
+#include "../../include/ldtools/fps_counter.h"
+#include "../../include/ldtools/frame_limiter.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//Runs a 60 fps loop with a varying amount of work per frame and waits for
+//the rest of each frame with the busy wait fps_counter::fill_until used to
+//run, with the current fill_until and with frame_limiter::wait. Reports
+//the processor time used while waiting and how far frames are from the
+//target duration.
+
+using bench_clock=std::chrono::steady_clock;
+
+struct result {
+	double      wall,       //!< Seconds.
+	            cpu,        //!< Seconds of processor time, user and system.
+	            work,       //!< Seconds spent on the simulated work.
+	            mean,       //!< Mean frame duration in seconds.
+	            jitter,     //!< Standard deviation of the frame duration.
+	            worst;      //!< Largest distance to the target duration.
+};
+
+double cpu_seconds();
+void work(double);
+result run(std::size_t, const std::vector<double>&, const std::function<void(ldtools::tdelta&, ldtools::tdelta)>&);
+void old_fill_until(ldtools::tdelta&, ldtools::tdelta);
+void print(const std::string&, const result&);
+
+constexpr double target=1. / 60.;
+
+int main(int argc, char ** argv) {
+
+	try {
+
+		const std::size_t frames=argc > 1 ? std::stoul(argv[1]) : 300;
+
+		std::mt19937 gen(42);
+		std::uniform_real_distribution<double> distribution(0.002, 0.010);
+		std::vector<double> loads(frames);
+		for(auto& load : loads) {
+
+			load=distribution(gen);
+		}
+
+		std::cout<<frames<<" frames at 60 fps, 2 to 10 ms of work each"<<std::endl;
+
+		print("busy wait", run(frames, loads, old_fill_until));
+
+		ldtools::fps_counter counter;
+		print("fill_until", run(frames, loads, [&counter](ldtools::tdelta& _produced, ldtools::tdelta _target) {
+			counter.fill_until(_produced, _target);
+		}));
+
+		//The limiter keeps its own schedule, so the time to fill is ignored.
+		ldtools::frame_limiter limiter{target};
+		limiter.wait();
+		print("frame_limiter", run(frames, loads, [&limiter](ldtools::tdelta&, ldtools::tdelta) {
+			limiter.wait();
+		}));
+
+		const auto& stats=limiter.get_stats();
+		std::cout<<"\tlimiter slept "<<stats.sleep_seconds<<" s, spun "<<stats.spin_seconds
+			<<" s, late by "<<stats.mean_error() * 1e6<<" us on average ("<<stats.jitter() * 1e6<<" us deviation, "
+			<<stats.max_error * 1e6<<" us worst), final margin "
+			<<std::chrono::duration_cast<std::chrono::microseconds>(limiter.get_margin()).count()<<" us"<<std::endl;
+
+		return 0;
+	}
+	catch(std::exception& e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
+
+//!Returns the processor time used by the process, in seconds.
+double cpu_seconds() {
+
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec+usage.ru_stime.tv_sec
+		+(usage.ru_utime.tv_usec+usage.ru_stime.tv_usec) / 1e6;
+}
+
+//!Keeps the processor busy for the given seconds.
+void work(
+	double _seconds
+) {
+
+	const auto end=bench_clock::now()+std::chrono::duration_cast<bench_clock::duration>(std::chrono::duration<double>(_seconds));
+	while(bench_clock::now() < end) {
+
+	}
+}
+
+//!Runs the loop, filling each frame with the given function.
+result run(
+	std::size_t _frames,
+	const std::vector<double>& _loads,
+	const std::function<void(ldtools::tdelta&, ldtools::tdelta)>& _fill
+) {
+
+	std::vector<double> durations;
+	durations.reserve(_frames);
+
+	const double cpu_start=cpu_seconds();
+	const auto start=bench_clock::now();
+	auto frame_start=start;
+
+	for(std::size_t i=0; i<_frames; i++) {
+
+		work(_loads[i]);
+
+		ldtools::tdelta produced=std::chrono::duration<double>(bench_clock::now()-frame_start).count();
+		_fill(produced, target);
+
+		const auto now=bench_clock::now();
+		durations.push_back(std::chrono::duration<double>(now-frame_start).count());
+		frame_start=now;
+	}
+
+	result res;
+	res.wall=std::chrono::duration<double>(bench_clock::now()-start).count();
+	res.cpu=cpu_seconds()-cpu_start;
+	res.work=0.;
+	for(auto load : _loads) {
+
+		res.work+=load;
+	}
+
+	double sum=0., squares=0., worst=0.;
+	for(auto d : durations) {
+
+		sum+=d;
+		squares+=d * d;
+		worst=std::max(worst, std::fabs(d-target));
+	}
+
+	res.mean=sum / _frames;
+	res.jitter=std::sqrt(std::max(0., squares / _frames-res.mean * res.mean));
+	res.worst=worst;
+	return res;
+}
+
+//!What fps_counter::fill_until used to do: spin measuring whole
+//!milliseconds until the time is filled.
+void old_fill_until(
+	ldtools::tdelta& _produced,
+	ldtools::tdelta _target
+) {
+
+	auto start=std::chrono::high_resolution_clock::now();
+	ldtools::tdelta diff=_target-_produced, curr=0.;
+	while(curr < diff) {
+
+		curr=std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count() / 1000.f;
+	}
+
+	_produced+=curr;
+}
+
+void print(
+	const std::string& _name,
+	const result& _result
+) {
+
+	const double waiting=_result.wall-_result.work,
+		waiting_cpu=std::max(0., _result.cpu-_result.work);
+
+	std::cout<<"\t"<<_name<<":\tcpu while waiting "<<100. * waiting_cpu / waiting<<"%"
+		<<"\tframe "<<_result.mean * 1000.<<" ms"
+		<<"\tjitter "<<_result.jitter * 1e6<<" us"
+		<<"\tworst "<<_result.worst * 1e6<<" us"<<std::endl;
+}
@@ -0,0 +1,61 @@
+#include "../../include/ldtools/frame_stats.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//Measures what frame_stats costs per frame added and per summary, for a
+//few window sizes.
+
+int main(int argc, char ** argv) {
+
+	try {
+
+		const std::size_t frames=argc > 1 ? std::stoul(argv[1]) : 10000000;
+
+		std::mt19937 gen(42);
+		std::lognormal_distribution<double> distribution(-4.1, 0.2);
+		std::vector<double> durations(4096);
+		for(auto& duration : durations) {
+
+			duration=distribution(gen);
+		}
+
+		for(std::size_t window : {60, 600, 6000}) {
+
+			ldtools::frame_stats stats{window};
+
+			const auto start=std::chrono::steady_clock::now();
+			for(std::size_t i=0; i<frames; i++) {
+
+				stats.add(durations[i % durations.size()]);
+			}
+			const std::chrono::duration<double, std::nano> add_time=std::chrono::steady_clock::now()-start;
+
+			const std::size_t summaries=1000;
+			double sink=0.;
+			const auto summary_start=std::chrono::steady_clock::now();
+			for(std::size_t i=0; i<summaries; i++) {
+
+				sink+=stats.summary().p99;
+			}
+			const std::chrono::duration<double, std::micro> summary_time=std::chrono::steady_clock::now()-summary_start;
+
+			const auto summary=stats.summary();
+			std::cout<<"window "<<window<<":\tadd "<<add_time.count() / frames<<" ns\tsummary "
+				<<summary_time.count() / summaries<<" us"
+				<<"\t(p50 "<<summary.p50 * 1000.<<" ms, p99 "<<summary.p99 * 1000.<<" ms, "
+				<<stats.get_hitches()<<" hitches, "<<(sink > 0. ? "ok" : "?")<<")"<<std::endl;
+		}
+
+		return 0;
+	}
+	catch(std::exception& e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
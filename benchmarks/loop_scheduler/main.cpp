@@ -0,0 +1,79 @@
+#include "../../include/ldtools/loop_scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+//Runs a 200 Hz simulation whose steps take 70% of the step duration, with
+//a spike of 20 frames where they take 120%. Without a cap on the steps per
+//frame each frame has more to catch up than the previous one (the spiral
+//of death); with the cap frames stay bounded and time is dropped instead.
+
+void work(double);
+void run(const std::string&, std::size_t, std::size_t);
+
+constexpr double step=0.005;
+
+int main(int argc, char ** argv) {
+
+	try {
+
+		const std::size_t frames=argc > 1 ? std::stoul(argv[1]) : 200;
+
+		run("uncapped", frames, std::numeric_limits<std::size_t>::max());
+		run("capped at 5", frames, 5);
+		return 0;
+	}
+	catch(std::exception& e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
+
+//!Keeps the processor busy for the given seconds.
+void work(
+	double _seconds
+) {
+
+	const auto end=std::chrono::steady_clock::now()+std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(_seconds));
+	while(std::chrono::steady_clock::now() < end) {
+
+	}
+}
+
+void run(
+	const std::string& _name,
+	std::size_t _frames,
+	std::size_t _max_steps
+) {
+
+	ldtools::loop_scheduler scheduler{step, _max_steps, step};
+
+	std::size_t most_steps=0;
+	double alpha_sum=0.;
+	const auto start=std::chrono::steady_clock::now();
+
+	for(std::size_t f=0; f<_frames; f++) {
+
+		const double cost=f >= 50 && f < 70 ? 1.2 * step : 0.7 * step;
+		const std::size_t steps=scheduler.frame(
+			[cost](ldtools::tdelta) {work(cost);},
+			[&alpha_sum](ldtools::tdelta _alpha) {alpha_sum+=_alpha;}
+		);
+
+		most_steps=std::max(most_steps, steps);
+	}
+
+	const std::chrono::duration<double> elapsed=std::chrono::steady_clock::now()-start;
+	const auto summary=scheduler.get_frame_stats().summary();
+
+	std::cout<<_name<<":\t"<<elapsed.count()<<" s, "<<scheduler.get_step_count()<<" steps, at most "<<most_steps
+		<<" in a frame, worst frame "<<summary.max * 1000.<<" ms, p99 "<<summary.p99 * 1000.<<" ms, dropped "
+		<<scheduler.get_dropped_time()<<" s in "<<scheduler.get_dropped_frames()<<" frames, mean alpha "
+		<<alpha_sum / _frames<<std::endl;
+}
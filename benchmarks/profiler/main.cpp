@@ -0,0 +1,99 @@
+#define LDTOOLS_PROFILER
+#include "../../include/ldtools/profiler.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Measures what a zone costs when recorded and when turned off at run time,
+//then records nested zones from a few threads and writes them as a Chrome
+//trace to profiler_trace.json.
+
+double measure(std::size_t);
+void nested(int);
+
+int main(int argc, char ** argv) {
+
+	try {
+
+		const std::size_t zones=argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+		std::cout<<"recorded:\t"<<measure(zones)<<" ns per zone"<<std::endl;
+		ldtools::profiler::clear();
+
+		ldtools::profiler::set_enabled(false);
+		std::cout<<"turned off:\t"<<measure(zones)<<" ns per zone"<<std::endl;
+		ldtools::profiler::set_enabled(true);
+
+		std::vector<std::thread> threads;
+		for(int i=0; i<4; i++) {
+
+			threads.emplace_back([i]() {
+
+				LDTOOLS_PROFILE_THREAD("worker "+std::to_string(i));
+				for(int frame=0; frame<10; frame++) {
+
+					nested(3);
+				}
+			});
+		}
+
+		{
+			LDTOOLS_PROFILE_ZONE("main");
+			nested(4);
+		}
+
+		for(auto& t : threads) {
+
+			t.join();
+		}
+
+		std::ofstream trace("profiler_trace.json");
+		ldtools::profiler::write_chrome_trace(trace);
+		std::cout<<ldtools::profiler::get_zone_count()<<" zones written to profiler_trace.json"<<std::endl;
+		return 0;
+	}
+	catch(std::exception& e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
+
+//!Returns the nanoseconds an empty zone takes.
+double measure(
+	std::size_t _zones
+) {
+
+	const auto start=std::chrono::steady_clock::now();
+	for(std::size_t i=0; i<_zones; i++) {
+
+		LDTOOLS_PROFILE_ZONE("empty");
+	}
+
+	const std::chrono::duration<double, std::nano> elapsed=std::chrono::steady_clock::now()-start;
+	return elapsed.count() / _zones;
+}
+
+//!Opens zones nested to the given depth, with some work at each level.
+void nested(
+	int _depth
+) {
+
+	LDTOOLS_PROFILE_ZONE("nested");
+
+	volatile double sink=0.;
+	for(int i=0; i<10000; i++) {
+
+		sink=sink+i * 0.5;
+	}
+
+	for(int i=0; i<_depth; i++) {
+
+		nested(_depth-1);
+	}
+}
@@ -0,0 +1,169 @@
+#include "../../include/ldtools/sprite_table.h"
+#include "../../include/ldtools/sprite_table_compiler.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+//Compares the stream based loop sprite_table::load used to run with the
+//current loader on generated multi-megabyte tables. The compiled format is
+//measured too.
+
+void generate_table(const std::string&, std::size_t);
+ldtools::sprite_table::container stream_load(const std::string&);
+double measure(const std::function<std::size_t()>&, std::size_t&);
+
+int main(int argc, char ** argv) {
+
+	try {
+
+		const std::string path{"sprite_table_load.txt"},
+			compiled_path{"sprite_table_load.bin"};
+
+		std::vector<std::size_t> sizes{100000, 500000, 2000000};
+		if(argc > 1) {
+
+			sizes={std::stoul(argv[1])};
+		}
+
+		for(auto lines : sizes) {
+
+			generate_table(path, lines);
+			ldtools::compile_sprite_table(path, compiled_path);
+
+			std::ifstream file(path, std::ios::binary | std::ios::ate);
+			std::cout<<lines<<" lines, "<<file.tellg() / (1024. * 1024.)<<" MB"<<std::endl;
+
+			std::size_t reference=0, count=0;
+			const double stream_time=measure([&path]() {return stream_load(path).size();}, reference);
+			std::cout<<"\tstream loop:\t"<<stream_time<<" ms"<<std::endl;
+
+			const double map_time=measure([&path]() {return ldtools::sprite_table{path}.size();}, count);
+			std::cout<<"\tload (map):\t"<<map_time<<" ms\t"<<stream_time / map_time<<"x"<<std::endl;
+
+			const double dense_time=measure([&path]() {return ldtools::sprite_table{path, ldtools::sprite_table::storage::dense}.size();}, count);
+			std::cout<<"\tload (dense):\t"<<dense_time<<" ms\t"<<stream_time / dense_time<<"x"<<std::endl;
+
+			const double compiled_time=measure([&compiled_path]() {return ldtools::sprite_table{}.load_compiled(compiled_path).size();}, count);
+			std::cout<<"\tload_compiled:\t"<<compiled_time<<" ms\t"<<stream_time / compiled_time<<"x"<<std::endl;
+
+			//Make sure all of them read the same thing.
+			const auto expected=stream_load(path);
+			const ldtools::sprite_table table{path};
+			for(const auto& entry : table) {
+
+				const auto& f=expected.at(entry.first);
+				if(!(f.box==entry.second.box) || f.disp_x!=entry.second.disp_x || f.disp_y!=entry.second.disp_y || f.flags!=entry.second.flags) {
+
+					throw std::runtime_error("loaders disagree on frame "+std::to_string(entry.first));
+				}
+			}
+
+			if(expected.size()!=table.size() || reference!=count) {
+
+				throw std::runtime_error("loaders disagree on size");
+			}
+		}
+
+		std::remove(path.c_str());
+		std::remove(compiled_path.c_str());
+		return 0;
+	}
+	catch(std::exception& e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
+
+//!Writes a table with comments, mixed separators and optional flags.
+void generate_table(
+	const std::string& _path,
+	std::size_t _lines
+) {
+
+	std::ofstream file(_path);
+	file<<"# X\tY\tW\tH\tDESPX\tDESPY\tFLAGS"<<std::endl;
+
+	for(std::size_t i=0; i<_lines; i++) {
+
+		if(0==i%50) {
+
+			file<<"# block "<<i / 50<<"\n\n";
+		}
+
+		const char * sep=i%3 ? "\t" : "  ";
+		file<<i<<sep<<(i*37)%4096<<sep<<(i*91)%4096<<sep<<16+i%48<<sep<<16+i%32<<sep<<-(int)(i%9)<<sep<<(int)(i%11)-5;
+		if(i%2) {
+
+			file<<sep<<i%16;
+		}
+
+		file<<"\n";
+	}
+}
+
+//!The loop sprite_table::load used before reading whole files.
+ldtools::sprite_table::container stream_load(
+	const std::string& _path
+) {
+
+	ldtools::sprite_table::container data;
+	std::ifstream input_file(_path);
+	std::stringstream ss{};
+	std::string line;
+	while(true) {
+
+		std::getline(input_file, line);
+		if(input_file.eof()) {
+			break;
+		}
+
+		if(!line.size() || '#'==line[0]) {
+			continue;
+		}
+
+		ss.clear();
+		ss.str(line);
+
+		ldtools::sprite_frame f{};
+		size_t index;
+		ss>>index>>f.box.origin.x>>f.box.origin.y>>f.box.w>>f.box.h>>f.disp_x>>f.disp_y;
+
+		if(ss.fail()) {
+
+			throw std::runtime_error("malformed line "+line);
+		}
+
+		ss>>f.flags;
+		data.insert(std::make_pair(index, f));
+	}
+
+	return data;
+}
+
+//!Returns the best of a few runs in milliseconds.
+double measure(
+	const std::function<std::size_t()>& _fn,
+	std::size_t& _count
+) {
+
+	double best=0.;
+	for(int i=0; i<3; i++) {
+
+		const auto start=std::chrono::steady_clock::now();
+		_count=_fn();
+		const std::chrono::duration<double, std::milli> elapsed=std::chrono::steady_clock::now()-start;
+
+		if(!i || elapsed.count() < best) {
+
+			best=elapsed.count();
+		}
+	}
+
+	return best;
+}
@@ -0,0 +1,114 @@
+#include "../../include/ldtools/sprite_table.h"
+
+#include <malloc.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+//Compares heap footprint, lookup and iteration times of the map and dense
+//storages of the sprite table on generated tables with sparse ranges.
+
+std::size_t heap_in_use();
+std::vector<std::size_t> generate_table(const std::string&, std::size_t);
+void measure(const std::string&, ldtools::sprite_table::storage, const std::string&, const std::vector<std::size_t>&);
+
+int main(int argc, char ** argv) {
+
+	try {
+
+		const std::string path{"sprite_table_storage.txt"};
+
+		std::vector<std::size_t> sizes{100000, 250000, 1000000};
+		if(argc > 1) {
+
+			sizes={std::stoul(argv[1])};
+		}
+
+		for(auto frames : sizes) {
+
+			auto indexes=generate_table(path, frames);
+			std::cout<<frames<<" frames"<<std::endl;
+			measure("map", ldtools::sprite_table::storage::map, path, indexes);
+			measure("dense", ldtools::sprite_table::storage::dense, path, indexes);
+		}
+
+		std::remove(path.c_str());
+		return 0;
+	}
+	catch(std::exception& e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
+
+std::size_t heap_in_use() {
+
+	return mallinfo2().uordblks;
+}
+
+//!Writes a table with ranges of 100 frames separated by gaps of 50 indexes,
+//!like "0-99 scenery, 150-249 items". Returns the indexes written.
+std::vector<std::size_t> generate_table(
+	const std::string& _path,
+	std::size_t _frames
+) {
+
+	std::ofstream file(_path);
+	std::vector<std::size_t> result;
+	result.reserve(_frames);
+
+	std::size_t index=0;
+	for(std::size_t i=0; i<_frames; i++) {
+
+		file<<index<<"\t"<<i%1024<<"\t"<<i/1024<<"\t32\t32\t"<<i%7<<"\t"<<i%5<<"\t"<<i%4<<"\n";
+		result.push_back(index);
+		index+=99==i%100 ? 51 : 1;
+	}
+
+	return result;
+}
+
+void measure(
+	const std::string& _name,
+	ldtools::sprite_table::storage _storage,
+	const std::string& _path,
+	const std::vector<std::size_t>& _indexes
+) {
+
+	using clock=std::chrono::steady_clock;
+
+	const auto heap_before=heap_in_use();
+	ldtools::sprite_table table{_path, _storage};
+	const auto heap=heap_in_use()-heap_before;
+
+	std::vector<std::size_t> lookups{_indexes};
+	std::shuffle(std::begin(lookups), std::end(lookups), std::mt19937{1});
+
+	auto start=clock::now();
+	long long checksum=0;
+	for(auto index : lookups) {
+
+		checksum+=table.get(index).box.origin.x;
+	}
+	const std::chrono::duration<double, std::milli> lookup_time=clock::now()-start;
+
+	start=clock::now();
+	for(const auto& entry : table) {
+
+		checksum+=entry.second.disp_x;
+	}
+	const std::chrono::duration<double, std::milli> iteration_time=clock::now()-start;
+
+	std::cout<<"\t"<<_name
+		<<"\theap: "<<heap<<" bytes ("<<(double)heap / table.size()<<" per frame)"
+		<<"\trandom get: "<<lookup_time.count()<<" ms"
+		<<"\titeration: "<<iteration_time.count()<<" ms"
+		<<"\t(checksum "<<checksum<<")"<<std::endl;
+}
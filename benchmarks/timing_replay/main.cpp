@@ -0,0 +1,179 @@
+#include "../../include/ldtools/sprite_table.h"
+#include "../../include/ldtools/animation_table.h"
+#include "../../include/ldtools/animation_player.h"
+#include "../../include/ldtools/loop_scheduler.h"
+#include "../../include/ldtools/timing_replay.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//Records the frame durations of a real 60 fps session and replays them
+//headlessly through loop_scheduler and animation_player, reporting the
+//processor time of each frame. Running the replay of the same recording
+//with two builds compares them under identical timing.
+//
+//	timing_replay record file [frames]
+//	timing_replay replay file [csv]
+//
+//Without arguments, records 120 frames to a temporary file and replays it.
+
+void record(const std::string&, std::size_t);
+void replay(const std::string&, const std::string&);
+void generate_tables(const std::string&, const std::string&);
+
+int main(int argc, char ** argv) {
+
+	try {
+
+		const std::vector<std::string> args(argv+1, argv+argc);
+
+		if(args.size() >= 2 && "record"==args[0]) {
+
+			record(args[1], args.size() > 2 ? std::stoul(args[2]) : 600);
+		}
+		else if(args.size() >= 2 && "replay"==args[0]) {
+
+			replay(args[1], args.size() > 2 ? args[2] : "");
+		}
+		else if(args.empty()) {
+
+			const std::string path{"timing_replay_session.txt"};
+			record(path, 120);
+			replay(path, "");
+			std::remove(path.c_str());
+		}
+		else {
+
+			throw std::runtime_error("use: timing_replay record file [frames] | timing_replay replay file [csv]");
+		}
+
+		return 0;
+	}
+	catch(std::exception& e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
+
+//!Runs a real 60 fps loop with a varying load and saves its frame
+//!durations.
+void record(
+	const std::string& _path,
+	std::size_t _frames
+) {
+
+	ldtools::real_time_source time;
+	ldtools::loop_scheduler scheduler{time, 1. / 60., 5, 1. / 60.};
+	ldtools::timing_recorder recorder{time};
+
+	std::mt19937 gen(7);
+	std::uniform_int_distribution<int> load(1, 8);
+
+	for(std::size_t i=0; i<_frames; i++) {
+
+		scheduler.frame(
+			[&](ldtools::tdelta) {
+
+				const auto end=std::chrono::steady_clock::now()+std::chrono::milliseconds(load(gen));
+				while(std::chrono::steady_clock::now() < end) {
+
+				}
+			},
+			[](ldtools::tdelta) {}
+		);
+
+		recorder.frame();
+	}
+
+	recorder.save(_path);
+	std::cout<<"recorded "<<_frames<<" frames to "<<_path<<std::endl;
+}
+
+//!Replays the recording through the loop and animation code.
+void replay(
+	const std::string& _path,
+	const std::string& _csv
+) {
+
+	const std::string sprites_path{"timing_replay_sprites.txt"},
+		animations_path{"timing_replay_animations.txt"};
+
+	generate_tables(sprites_path, animations_path);
+	const ldtools::sprite_table sprites{sprites_path};
+	const ldtools::animation_table animations{sprites, animations_path};
+	std::remove(sprites_path.c_str());
+	std::remove(animations_path.c_str());
+
+	ldtools::recorded_time_source time{_path};
+	ldtools::loop_scheduler scheduler{time, 1. / 60., 5};
+
+	std::vector<ldtools::animation_player> players;
+	for(std::size_t i=0; i<20000; i++) {
+
+		players.emplace_back(animations.get(1+i % 8), ldtools::animation_player::modes::loop);
+	}
+
+	std::size_t frames_entered=0, checksum=0;
+	ldtools::timing_replay harness{time};
+	harness.run([&](ldtools::tdelta) {
+
+		scheduler.frame(
+			[&](ldtools::tdelta _step) {
+
+				for(auto& player : players) {
+
+					frames_entered+=player.advance(_step);
+				}
+			},
+			[&](ldtools::tdelta) {
+
+				for(const auto& player : players) {
+
+					checksum+=player.get_index();
+				}
+			}
+		);
+	});
+
+	const auto summary=harness.get_cost_stats().summary();
+	std::cout<<"replayed "<<summary.frames<<" frames, "<<scheduler.get_step_count()<<" steps, "
+		<<frames_entered<<" animation frames entered (checksum "<<checksum<<")"<<std::endl
+		<<"\tcpu per frame: mean "<<summary.mean * 1e6<<" us, p50 "<<summary.p50 * 1e6<<" us, p95 "
+		<<summary.p95 * 1e6<<" us, p99 "<<summary.p99 * 1e6<<" us, max "<<summary.max * 1e6<<" us"<<std::endl;
+
+	if(_csv.size()) {
+
+		std::ofstream out(_csv);
+		harness.write_csv(out);
+	}
+}
+
+//!Writes a sprite table and eight animations of varying frame durations.
+void generate_tables(
+	const std::string& _sprites_path,
+	const std::string& _animations_path
+) {
+
+	std::ofstream sprites(_sprites_path);
+	for(std::size_t i=0; i<64; i++) {
+
+		sprites<<i<<"\t"<<i*16<<"\t0\t16\t16\t0\t0\n";
+	}
+
+	std::ofstream animations(_animations_path);
+	for(std::size_t a=1; a<=8; a++) {
+
+		animations<<"*animation_"<<a<<"\n!"<<a<<"\n";
+		for(std::size_t i=0; i<4+a; i++) {
+
+			animations<<20*(1+(a+i)%5)<<"\t"<<(a*8+i)%64<<"\n";
+		}
+	}
+}
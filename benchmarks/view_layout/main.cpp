@@ -0,0 +1,241 @@
+#include "../../include/ldtools/view_composer.h"
+#include "../../include/ldtools/view_layout_compiler.h"
+
+#include <ldv/box_representation.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//Mounts one layout of a generated file with many layouts, through the json
+//path (reading the file and building the document, then parsing the node)
+//and through the compiled one (mapping the file, then parsing the layout).
+//The json file is also streamed with the SAX parser, for the first layout
+//and for the last one, and parsed in situ from a buffer. Both are measured
+//with the file already loaded too, as when a program keeps the document or
+//the compiled layout around between screens.
+//
+//	view_layout [layouts] [tokens per layout]
+
+void generate_layouts(const std::string&, std::size_t, std::size_t);
+double measure(const std::function<std::size_t()>&, std::size_t&);
+void check(std::size_t, std::size_t);
+
+int main(int argc, char ** argv) {
+
+	try {
+
+		const std::size_t layouts=argc > 1 ? std::stoul(argv[1]) : 32,
+			tokens=argc > 2 ? std::stoul(argv[2]) : 200;
+
+		const std::string path{"view_layout.json"},
+			compiled_path{"view_layout.bin"},
+			layout{"layout_0"};
+
+		generate_layouts(path, layouts, tokens);
+		ldtools::compile_view_layout(path, compiled_path);
+
+		std::ifstream json_file(path, std::ios::binary | std::ios::ate),
+			compiled_file(compiled_path, std::ios::binary | std::ios::ate);
+		std::cout<<layouts<<" layouts of "<<tokens<<" tokens, json "<<json_file.tellg() / 1024.
+			<<" KB, compiled "<<compiled_file.tellg() / 1024.<<" KB"<<std::endl;
+
+		ldv::box_representation external{ldv::rect{0, 0, 10, 10}, ldv::rgba8(0, 0, 0, 255), ldv::polygon_representation::type::fill};
+
+		auto mount=[&external](auto&& _parse) {
+
+			ldtools::view_composer composer;
+			composer.register_as_external("external", external);
+			_parse(composer);
+			return composer.size();
+		};
+
+		auto read_document=[&path](rapidjson::Document& _document) {
+
+			std::ifstream file(path, std::ios::binary);
+			std::stringstream contents;
+			contents<<file.rdbuf();
+			_document.Parse(contents.str().c_str());
+		};
+
+		std::size_t reference=0, count=0, tokens_reference=0, tokens_count=0;
+
+		const double json_time=measure([&]() {
+
+			rapidjson::Document document;
+			read_document(document);
+			return mount([&](ldtools::view_composer& _composer) {_composer.parse(document[layout.c_str()]);});
+		}, reference);
+		std::cout<<"\tjson file:\t"<<json_time<<" ms"<<std::endl;
+
+		const double compiled_time=measure([&]() {
+
+			ldtools::compiled_view_layout compiled{compiled_path};
+			return mount([&](ldtools::view_composer& _composer) {_composer.parse(compiled, layout);});
+		}, count);
+		check(reference, count);
+		std::cout<<"\tcompiled file:\t"<<compiled_time<<" ms\t"<<json_time / compiled_time<<"x"<<std::endl;
+
+		const double sax_time=measure([&]() {
+
+			return mount([&](ldtools::view_composer& _composer) {_composer.parse_file(path, layout);});
+		}, count);
+		check(reference, count);
+		std::cout<<"\tsax file:\t"<<sax_time<<" ms\t"<<json_time / sax_time<<"x"<<std::endl;
+
+		const std::string last_layout{"layout_"+std::to_string(layouts-1)};
+		const double sax_last_time=measure([&]() {
+
+			return mount([&](ldtools::view_composer& _composer) {_composer.parse_file(path, last_layout);});
+		}, count);
+		check(reference, count);
+		std::cout<<"\tsax file, last layout:\t"<<sax_last_time<<" ms\t"<<json_time / sax_last_time<<"x"<<std::endl;
+
+		std::stringstream contents;
+		contents<<std::ifstream(path, std::ios::binary).rdbuf();
+		const std::string text=contents.str();
+		std::vector<char> buffer;
+		const double insitu_time=measure([&]() {
+
+			//In situ parsing writes to the buffer, so it is restored each time.
+			buffer.assign(text.c_str(), text.c_str()+text.size()+1);
+			return mount([&](ldtools::view_composer& _composer) {_composer.parse_insitu(buffer.data(), layout);});
+		}, count);
+		check(reference, count);
+		std::cout<<"\tsax in situ:\t"<<insitu_time<<" ms\t"<<json_time / insitu_time<<"x"<<std::endl;
+
+		rapidjson::Document document;
+		read_document(document);
+		const double dom_time=measure([&]() {
+
+			return mount([&](ldtools::view_composer& _composer) {_composer.parse(document[layout.c_str()]);});
+		}, count);
+		check(reference, count);
+		std::cout<<"\tjson node:\t"<<dom_time<<" ms"<<std::endl;
+
+		const ldtools::compiled_view_layout compiled{compiled_path};
+		const double mapped_time=measure([&]() {
+
+			return mount([&](ldtools::view_composer& _composer) {_composer.parse(compiled, layout);});
+		}, count);
+		check(reference, count);
+		std::cout<<"\tcompiled layout:\t"<<mapped_time<<" ms\t"<<dom_time / mapped_time<<"x"<<std::endl;
+
+		//Token reading alone, without building representations.
+		ldtools::view_token token;
+		const double read_json_time=measure([&]() {
+
+			std::size_t read=0;
+			for(const auto& value : document[layout.c_str()].GetArray()) {
+
+				ldtools::view_composer::read_token(value, token);
+				read+=token.points.size()+1;
+			}
+			return read;
+		}, tokens_reference);
+		std::cout<<"\tjson tokens:\t"<<read_json_time<<" ms"<<std::endl;
+
+		const double read_compiled_time=measure([&]() {
+
+			std::size_t read=0;
+			const auto range=compiled.find(layout);
+			for(auto i=range.first; i<range.second; i++) {
+
+				compiled.read(i, token);
+				read+=token.points.size()+1;
+			}
+			return read;
+		}, tokens_count);
+		check(tokens_reference, tokens_count);
+		std::cout<<"\tcompiled tokens:\t"<<read_compiled_time<<" ms\t"<<read_json_time / read_compiled_time<<"x"<<std::endl;
+
+		std::remove(path.c_str());
+		std::remove(compiled_path.c_str());
+		return 0;
+	}
+	catch(std::exception& e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
+
+//!Writes a file with the given number of layouts, each with the given
+//!number of boxes, polygons, definitions and externals.
+void generate_layouts(
+	const std::string& _path,
+	std::size_t _layouts,
+	std::size_t _tokens
+) {
+
+	std::ofstream file(_path);
+	file<<"{\n";
+
+	for(std::size_t l=0; l<_layouts; l++) {
+
+		file<<"\"layout_"<<l<<"\":[\n"
+			<<"\t{\"type\":\"screen\", \"rgba\":[0, 0, 0, 255]},\n"
+			<<"\t{\"type\":\"external\", \"ref\":\"external\", \"order\":5}";
+
+		for(std::size_t i=0; i<_tokens; i++) {
+
+			file<<",\n\t";
+			switch(i % 3) {
+
+				case 0:
+					file<<"{\"type\":\"box\", \"id\":\"box_"<<i<<"\", \"location\":["<<i<<", "<<i*2<<", 32, 16], \"rgba\":[255, 128, 0, 255], \"order\":"<<i % 7<<", \"alpha\":200}";
+				break;
+				case 1:
+					file<<"{\"type\":\"polygon\", \"id\":\"polygon_"<<i<<"\", \"rgba\":[0, 128, 255, 255], \"fill\":\"line\", \"points\":[[0, 0], ["<<i<<", 10], [20, "<<i<<"], [5, 5]], \"visible\":false}";
+				break;
+				case 2:
+					file<<"{\"type\":\"define\", \"key\":\"value_"<<i<<"\", \"value\":"<<(i % 2 ? std::to_string(i) : std::to_string(i)+".5")<<"}";
+				break;
+			}
+		}
+
+		file<<"\n]"<<(l+1 < _layouts ? ",\n" : "\n");
+	}
+
+	file<<"}\n";
+}
+
+//!Runs the function a few times and returns the best time in milliseconds.
+double measure(
+	const std::function<std::size_t()>& _function,
+	std::size_t& _result
+) {
+
+	double best=0.;
+	for(int i=0; i<10; i++) {
+
+		const auto start=std::chrono::steady_clock::now();
+		_result=_function();
+		const std::chrono::duration<double, std::milli> elapsed=std::chrono::steady_clock::now()-start;
+
+		if(0==i || elapsed.count() < best) {
+
+			best=elapsed.count();
+		}
+	}
+
+	return best;
+}
+
+//!Makes sure both paths read the same thing.
+void check(
+	std::size_t _reference,
+	std::size_t _count
+) {
+
+	if(_reference!=_count) {
+
+		throw std::runtime_error("json and compiled layouts disagree");
+	}
+}
@@ -0,0 +1,51 @@
+#Helpers to compile sprite and animation tables into a program as C++
+#headers, through the asset_embedder utility. The generated headers declare
+#an ldtools::embedded_sprite_table or ldtools::embedded_animation_table with
+#the given name, which sprite_table and animation_table can be built from.
+#
+#Add the output to the sources of a target (or depend on it) so the header
+#is generated again when the tables change:
+#
+#	ldtools_embed_sprite_table(${CMAKE_CURRENT_BINARY_DIR}/hero_sprites.h hero_sprites data/hero.txt)
+#	ldtools_embed_animation_table(${CMAKE_CURRENT_BINARY_DIR}/hero_animations.h hero_animations data/hero.txt data/hero_animations.txt)
+#	add_executable(game main.cpp ${CMAKE_CURRENT_BINARY_DIR}/hero_sprites.h ${CMAKE_CURRENT_BINARY_DIR}/hero_animations.h)
+#
+#The utility is the asset_embedder target when it is part of the build, or
+#is looked up in the path (it can be forced with LDTOOLS_ASSET_EMBEDDER).
+
+if(NOT LDTOOLS_ASSET_EMBEDDER)
+
+	if(TARGET asset_embedder)
+
+		set(LDTOOLS_ASSET_EMBEDDER $<TARGET_FILE:asset_embedder>)
+		set(LDTOOLS_ASSET_EMBEDDER_DEPENDS asset_embedder)
+	else()
+
+		find_program(LDTOOLS_ASSET_EMBEDDER asset_embedder)
+	endif()
+endif()
+
+function(ldtools_embed_sprite_table _output _name _sprites)
+
+	get_filename_component(_sprites ${_sprites} ABSOLUTE)
+	add_custom_command(
+		OUTPUT ${_output}
+		COMMAND ${LDTOOLS_ASSET_EMBEDDER} sprites ${_sprites} ${_name} ${_output}
+		DEPENDS ${_sprites} ${LDTOOLS_ASSET_EMBEDDER_DEPENDS}
+		COMMENT "Embedding sprite table ${_sprites}"
+		VERBATIM
+	)
+endfunction()
+
+function(ldtools_embed_animation_table _output _name _sprites _animations)
+
+	get_filename_component(_sprites ${_sprites} ABSOLUTE)
+	get_filename_component(_animations ${_animations} ABSOLUTE)
+	add_custom_command(
+		OUTPUT ${_output}
+		COMMAND ${LDTOOLS_ASSET_EMBEDDER} animations ${_sprites} ${_animations} ${_name} ${_output}
+		DEPENDS ${_sprites} ${_animations} ${LDTOOLS_ASSET_EMBEDDER_DEPENDS}
+		COMMENT "Embedding animation table ${_animations}"
+		VERBATIM
+	)
+endfunction()
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "animation_table.h"
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace ldtools {
+
+//!Exception thrown by the batch animation evaluator.
+
+class animation_batch_exception:
+	public std::runtime_error {
+
+	public:
+	                animation_batch_exception(const std::string& _msg)
+		:std::runtime_error(_msg) {
+
+	}
+};
+
+//!Evaluates animations for many entities at once.
+
+//!Takes a snapshot of an animation table: the end times of all frames are
+//!packed in a single pool and each animation becomes an offset, a count and
+//!a duration. Entities are given as arrays (animation id, time and an
+//!optional duration override each) and processed in blocks: times are
+//!wrapped in a loop the compiler can vectorise and the frames of all
+//!entities in a block are searched in lockstep, so their memory accesses
+//!overlap instead of waiting on each other. Results are the same as
+//!animation::index_for_time. Large batches can be split across threads,
+//!which are started by the first batch that needs them and kept until the
+//!evaluator is destroyed. Batches that use them run one at a time. The
+//!table must outlive the evaluator, which must be built again if the table
+//!is loaded or reloaded.
+
+class animation_batch {
+
+	public:
+
+	//!Takes a snapshot of the given table. Batches will be split in up to the
+	//!given number of threads, zero meaning as many as the hardware supports.
+	                        animation_batch(const animation_table&, std::size_t=1);
+	//!Class destructor, stops the threads.
+	                        ~animation_batch();
+	                        animation_batch(const animation_batch&)=delete;
+	animation_batch&        operator=(const animation_batch&)=delete;
+
+	//!Takes the snapshot again, after the table has changed.
+	void                    rebuild();
+
+	//!Writes the frame index for each entity, given the animation ids, the
+	//!times and the duration each animation should have (which can be null
+	//!to use their own). All arrays must hold the count given. Will throw
+	//!animation_batch_exception if an animation id does not exist.
+	void                    index_for_time(const std::size_t *, const float *, const float *, std::size_t, std::size_t *) const;
+
+	//!Same as index_for_time, writes pointers to the frames of the sprite
+	//!table as copied in the animation lines.
+	void                    frames_for_time(const std::size_t *, const float *, const float *, std::size_t, const sprite_frame **) const;
+
+	//!Returns the number of animations in the snapshot.
+	std::size_t             size() const {return sources.size();}
+
+	private:
+
+	//!Runs the kernel for the given range of entities.
+	template<typename O>
+	void                    evaluate(const std::size_t *, const float *, const float *, std::size_t, std::size_t, O) const;
+
+	//!Splits the entities among the threads and runs the kernel.
+	template<typename O>
+	void                    run(const std::size_t *, const float *, const float *, std::size_t, O) const;
+
+	//!Returns the snapshot slot of an animation id, or none.
+	std::uint32_t           slot_for(std::size_t) const;
+
+	//!Threads that run the chunks of large batches.
+	class worker_pool;
+
+	const animation_table&              table;
+	std::size_t                         threads;
+	std::unique_ptr<worker_pool>        helpers;    //!< Null when single threaded.
+	std::vector<float>                  ends;       //!< End times of all frames.
+	std::vector<std::uint32_t>          offsets,    //!< First frame of each animation in ends.
+	                                    counts;     //!< Frames in each animation.
+	std::vector<float>                  durations;  //!< Duration of each animation.
+	std::vector<unsigned char>          sorted;     //!< Animations that can be searched.
+	std::vector<const animation *>      sources;    //!< Animations, for the slow cases.
+	std::vector<std::size_t>            ids;        //!< Sorted animation ids.
+	std::vector<std::uint32_t>          direct;     //!< Slot by id, when ids are small.
+	unsigned                            steps{0};   //!< Search steps for the longest animation.
+
+	static constexpr std::uint32_t      none=0xffffffff;
+};
+
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "animation_player.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ldtools {
+
+//!An event of an animation frame, entered by an entity.
+struct animation_event {
+	std::size_t         entity;     //!< Entity that entered the frame.
+	std::size_t         frame;      //!< Frame index.
+	std::uint32_t       event;      //!< Event id, see animation_table::get_event_id.
+};
+
+//!Callback that does not allocate: a function and a pointer passed to it.
+class animation_event_delegate {
+
+	public:
+
+	using                       function=void (*)(void *, const animation_event&);
+
+	                            animation_event_delegate(function _fn, void * _context)
+		:fn(_fn), context(_context) {
+
+	}
+
+	//!Builds a delegate that calls the given member function on the given
+	//!object, which must outlive it.
+	template<typename T, void (T::*M)(const animation_event&)>
+	static animation_event_delegate bind(T& _object) {
+
+		return {[](void * _context, const animation_event& _event) {
+
+			(static_cast<T *>(_context)->*M)(_event);
+		}, &_object};
+	}
+
+	void                        operator()(const animation_event& _event) const {fn(context, _event);}
+
+	private:
+
+	function                    fn;
+	void *                      context;
+};
+
+//!Collects the frame events of many animated entities and dispatches them
+//!in one pass.
+
+//!Entities are advanced in batches through their animation_player: every
+//!frame entered is checked for events, even the ones a long step skips
+//!over, and each event found goes to a contiguous queue. dispatch calls the
+//!delegates subscribed to each event and empties the queue. Meant to
+//!replace one animation_event_handler per entity.
+class animation_event_bus {
+
+	public:
+
+	//!Subscribes a delegate to the given event id.
+	void                        subscribe(std::uint32_t, animation_event_delegate);
+
+	//!Subscribes a delegate to all events.
+	void                        subscribe(animation_event_delegate);
+
+	//!Removes all subscriptions.
+	void                        clear_subscriptions();
+
+	//!Advances each player by its delta and queues the events of the frames
+	//!entered. Entity ids are the position in the arrays plus the last
+	//!parameter, so the same entities can be advanced in several batches.
+	//!Returns the number of events queued.
+	std::size_t                 advance(animation_player *, const float *, std::size_t, std::size_t=0);
+
+	//!Queues an event by hand.
+	void                        push(const animation_event& _event) {queue.push_back(_event);}
+
+	//!Calls the delegates for every queued event, in queue order, and
+	//!empties the queue. Returns the number of events dispatched.
+	std::size_t                 dispatch();
+
+	//!Returns the queued events.
+	const std::vector<animation_event>& get_queue() const {return queue;}
+
+	//!Empties the queue without dispatching.
+	void                        clear() {queue.clear();}
+
+	private:
+
+	std::vector<animation_event>                        queue;
+	std::vector<std::vector<animation_event_delegate>>  by_event;   //!< Subscribers by event id.
+	std::vector<animation_event_delegate>               to_all;     //!< Subscribers to all events.
+};
+
+}
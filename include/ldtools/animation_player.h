@@ -0,0 +1,263 @@
+#pragma once
+
+#include "animation_table.h"
+#include "animation_store.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace ldtools {
+
+//!Plays an animation by advancing time in small steps.
+
+//!Keeps the current frame and the time inside the animation, so each step
+//!only looks at the frames it crosses instead of searching from the first
+//!one, and the time stays small instead of growing forever. In loop mode
+//!the frame is the one index_for_time gives for get_time(). In once mode
+//!the last frame stays when the animation ends. In ping pong mode the
+//!animation goes back and forth, without repeating the frames at both ends.
+//!The first frame is entered by the first advance after construction or
+//!reset, so its events are reported like those of any other frame. The
+//!animation must outlive the player. An animation replaced by
+//!animation_table::reload is picked up by the next advance or reset, which
+//!keep the time and move to the frame it falls in. Players of an
+//!animation_handle are not told: like the handle, they are valid until the
+//!store is built again.
+class animation_player {
+
+	public:
+
+	enum class modes {loop, once, ping_pong};
+
+	//!Plays the given animation. Will throw std::runtime_error if it has no
+	//!frames or no duration.
+	                            animation_player(const animation&, modes=modes::loop);
+
+	//!Plays the given animation. Will throw std::runtime_error if it has no
+	//!frames or no duration.
+	                            animation_player(const animation_handle&, modes=modes::loop);
+
+	//!Goes back to the first frame, which the next advance enters again.
+	//!Will throw std::runtime_error if a reload left the animation without
+	//!frames or duration.
+	void                        reset();
+
+	//!Advances the given time. Deltas that are not positive and finite do
+	//!nothing. Returns the number of frames entered.
+	std::size_t                 advance(float _delta) {return advance(_delta, [](std::size_t) {});}
+
+	//!Advances the given time, calling the second parameter with the index
+	//!of each frame entered, in order, starting with the first frame if
+	//!nothing was played yet. Deltas that are not positive and finite do
+	//!nothing. Returns the number of frames entered. A delta
+	//!spanning many whole passes (loops, or back and forths in ping pong
+	//!mode) only enters the frames of the first max_walked_passes of them:
+	//!the rest are skipped at once, whatever their size. Will throw
+	//!std::runtime_error if a reload left the animation without frames or
+	//!duration.
+	template<typename F>
+	std::size_t                 advance(float, F&&);
+
+	//!Returns the index of the current frame.
+	std::size_t                 get_index() const {return cursor;}
+
+	//!Returns the current frame. Reads the animation as it is now, so
+	//!between a reload and the next advance the index may be gone, and
+	//!std::out_of_range is thrown.
+	const animation_line&       get() const {return source ? source->get(cursor) : lines[cursor];}
+
+	//!Returns the events of the given frame as a range of event ids. Reads
+	//!the animation as get does.
+	std::pair<const std::uint32_t *, const std::uint32_t *> get_events(std::size_t _index) const {
+
+		if(source) {
+
+			return source->get_events(_index);
+		}
+
+		return {events+lines[_index].first_event, events+lines[_index].first_event+lines[_index].event_count};
+	}
+
+	//!Returns the time inside the animation.
+	float                       get_time() const {return position;}
+
+	//!Returns true once an animation in once mode has ended.
+	bool                        is_finished() const {return finished;}
+
+	modes                       get_mode() const {return mode;}
+
+	//!Whole passes in a single delta whose frames are still entered.
+	static constexpr float      max_walked_passes=8.f;
+
+	private:
+
+	//!Checks the animation can be played, given whether its frames are
+	//!sorted.
+	void                        check(bool) const;
+
+	//!Reads the animation again after a reload, keeping the time.
+	void                        rebind();
+
+	const animation *           source{nullptr};   //!< Null when playing a handle.
+	std::uint32_t               revision{0};        //!< Revision of the source read.
+	const animation_line *      lines;
+	const float *               ends;       //!< End time of each frame.
+	const std::uint32_t *       events;     //!< Event ids the lines refer to.
+	std::size_t                 count;
+	float                       duration;
+	modes                       mode;
+	float                       position{0.f};
+	std::size_t                 cursor{0};
+	bool                        forward{true},
+	                            finished{false},
+	                            started{false};     //!< The first frame was entered.
+};
+
+template<typename F>
+std::size_t animation_player::advance(
+	float _delta,
+	F&& _fn
+) {
+
+	if(source && source->revision!=revision) {
+
+		rebind();
+	}
+
+	if(!(std::isfinite(_delta) && _delta > 0.f) || finished) {
+
+		return 0;
+	}
+
+	std::size_t entered=0;
+	auto enter=[&](std::size_t _index) {
+
+		cursor=_index;
+		++entered;
+		_fn(_index);
+	};
+
+	if(!started) {
+
+		started=true;
+		enter(0);
+	}
+
+	switch(mode) {
+
+		case modes::loop: {
+
+			const float rest=duration-position;
+			if(_delta < rest) {
+
+				position+=_delta;
+			}
+			else {
+
+				//Ends the current pass, then jumps over the whole passes
+				//in the delta, only walking the first few of them.
+				for(std::size_t i=cursor+1; i<count; i++) {
+					enter(i);
+				}
+
+				const float over=_delta-rest,
+					whole=std::floor(over / duration);
+
+				for(float pass=0.f; pass < whole && pass < max_walked_passes; pass+=1.f) {
+
+					enter(0);
+					for(std::size_t i=1; i<count; i++) {
+						enter(i);
+					}
+				}
+
+				position=std::fmod(over, duration);
+				enter(0);
+			}
+
+			while(position > ends[cursor]) {
+				enter(cursor+1);
+			}
+		}
+		break;
+
+		case modes::once:
+
+			position+=_delta;
+			if(position >= duration) {
+
+				position=duration;
+				finished=true;
+			}
+
+			while(cursor+1 < count && position > ends[cursor]) {
+				enter(cursor+1);
+			}
+		break;
+
+		case modes::ping_pong: {
+
+			//Each back and forth ends where it began, so whole ones are
+			//jumped over and only the first few of them walked.
+			const float period=2.f*duration,
+				whole=std::floor(_delta / period);
+
+			auto bounce=[&](float remaining) {
+
+				while(remaining > 0.f) {
+
+					if(forward) {
+
+						const float room=duration-position;
+						if(remaining < room) {
+
+							position+=remaining;
+							remaining=0.f;
+						}
+						else {
+
+							position=duration;
+							remaining-=room;
+							forward=false;
+						}
+
+						while(cursor+1 < count && position > ends[cursor]) {
+							enter(cursor+1);
+						}
+					}
+					else {
+
+						if(remaining < position) {
+
+							position-=remaining;
+							remaining=0.f;
+						}
+						else {
+
+							remaining-=position;
+							position=0.f;
+							forward=true;
+						}
+
+						while(cursor > 0 && position <= ends[cursor-1]) {
+							enter(cursor-1);
+						}
+					}
+				}
+			};
+
+			for(float pass=0.f; pass < whole && pass < max_walked_passes; pass+=1.f) {
+				bounce(period);
+			}
+
+			bounce(std::fmod(_delta, period));
+		}
+		break;
+	}
+
+	return entered;
+}
+
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "animation_table.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ldtools {
+
+class animation_store;
+
+//!View of an animation kept in an animation_store.
+
+//!Two pointers and a few values: cheap to copy and to keep around. Offers
+//!the same queries as animation, with the same results. Valid as long as
+//!the store is alive and not rebuilt.
+class animation_handle {
+
+	public:
+
+	//!Returns the frame at the given index. Will throw if the index is not valid.
+	const animation_line&       get(std::size_t) const;
+
+	//!Returns the frame at the given index, unchecked.
+	const animation_line&       operator[](std::size_t _index) const {return lines[_index];}
+
+	//!Same as animation::get_for_time.
+	const animation_line&       get_for_time(float) const;
+
+	//!Same as animation::get_for_time.
+	const animation_line&       get_for_time(float, float) const;
+
+	//!Same as animation::index_for_time.
+	std::size_t                 index_for_time(float) const;
+
+	//!Same as animation::index_for_time.
+	std::size_t                 index_for_time(float, float) const;
+
+	//!Returns the number of frames in the animation.
+	std::size_t                 size() const {return count;}
+
+	//!Returns the animation name.
+	const std::string&          get_name() const {return *name;}
+
+	//!Returns the animation duration.
+	float                       get_duration() const {return duration;}
+
+	//!Same as animation::get_events.
+	std::pair<const std::uint32_t *, const std::uint32_t *> get_events(std::size_t) const;
+
+	//!The frames, contiguous.
+	const animation_line *      begin() const {return lines;}
+	const animation_line *      end() const {return lines+count;}
+
+	private:
+
+	                            animation_handle(const animation_line *, const float *, const std::uint32_t *, const std::string *, std::uint32_t, float, bool);
+
+	const animation_line *      lines;
+	const float *               ends;       //!< End time of each frame.
+	const std::uint32_t *       events;     //!< Event ids the lines refer to.
+	const std::string *         name;
+	std::uint32_t               count;
+	float                       duration;
+	bool                        sorted;
+
+	friend class animation_store;
+	friend class animation_player;
+};
+
+//!Read only copy of an animation table with all the frames of all the
+//!animations in a single contiguous pool.
+
+//!Each animation is an offset, a length and a duration into the pool, and
+//!is accessed through an animation_handle, so lookups never copy nor
+//!allocate. Ids are looked up in a vector when they are small, by binary
+//!search otherwise. The store is a snapshot: build it again when the table
+//!is loaded or reloaded.
+class animation_store {
+
+	public:
+
+	//!Empty store.
+	                            animation_store();
+
+	//!Copies the given table.
+	explicit                    animation_store(const animation_table&);
+
+	//!Copies the given table, dropping what was stored before.
+	void                        build(const animation_table&);
+
+	//!Returns the animation with the given id. Will throw std::out_of_range
+	//!if it does not exist.
+	animation_handle            get(std::size_t) const;
+
+	//!Returns true if there is an animation with the given id.
+	bool                        exists(std::size_t) const;
+
+	//!Returns the number of animations.
+	std::size_t                 size() const {return ids.size();}
+
+	//!Returns the id of each animation, sorted.
+	const std::vector<std::size_t>& get_ids() const {return ids;}
+
+	private:
+
+	//!Where an animation is in the pool.
+	struct record {
+		std::uint32_t           offset,
+		                        length;
+		float                   duration;
+		bool                    sorted;
+	};
+
+	//!Returns the position of the record of an id, or none.
+	std::uint32_t               position(std::size_t) const;
+
+	std::vector<animation_line> lines;      //!< All frames of all animations.
+	std::vector<float>          ends;       //!< End time of each frame, same order.
+	std::vector<std::uint32_t>  events;     //!< Event ids of all frames, referred from the lines.
+	std::vector<record>         records;    //!< In id order.
+	std::vector<std::string>    names;      //!< Same order as the records.
+	std::vector<std::size_t>    ids;        //!< Sorted animation ids.
+	std::vector<std::uint32_t>  direct;     //!< Position by id, when ids are small.
+
+	static constexpr std::uint32_t none=0xffffffff;
+};
+
+}
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "sprite_table.h"
+#include "embedded_assets.h"
 
+#include <cstdint>
 #include <map>
 #include <vector>
 #include <stdexcept>
@@ -28,6 +30,10 @@ struct animation_line {
 					animation_line(float d, float m, const sprite_frame& f, int _flags)
 						:duration(d), begin_time(m), frame(f), flags(_flags) {}
 
+	//!Class constructor, with the index of the frame in the sprite table.
+					animation_line(float d, float m, const sprite_frame& f, int _flags, std::size_t _index)
+						:duration(d), begin_time(m), frame(f), flags(_flags), frame_index(_index) {}
+
 	//!Checks the line has data.
 					explicit operator bool() const {return duration && frame;}
 
@@ -44,6 +50,9 @@ struct animation_line {
 	float               begin_time=0.0f;	//!< Starting ms of the frame... or maybe ending. Who knows.
 	sprite_frame        frame;			//!< Frame data.
 	int                 flags;        //!< Transformation flags flags.
+	std::size_t         frame_index{0};	//!< Index of the frame in the sprite table.
+	std::uint32_t       first_event{0},	//!< First of the events of the frame, in the animation.
+	                    event_count{0};	//!< Number of events of the frame.
 };
 
 class animation_table;
@@ -59,13 +68,11 @@ class animation {
 
 	//!Returns the frame at the given index. Will throw if the index is not valid.
 	const animation_line&		get(size_t v) const {return data.at(v);}
-	
-	//!Returns the frame at the given index. Will throw if the index is not valid.
-	animation_line			get(size_t v) {return data.at(v);}
 
 	//!Given a moment in time expressed as a float, returns the corresponding
 	//!frame of the animation Values larger than the animation length will 
-	//!be treated as if the animation loops.
+	//!be treated as if the animation loops. Frames are found by binary
+	//!search.
 	const animation_line&		get_for_time(float) const;
 
 
@@ -73,8 +80,9 @@ class animation {
 	//!animation would have a duration defined by the second parameter.
 	const animation_line&		get_for_time(float, float) const;
 
-
+	//!Same as get_for_time, returns the index of the frame.
 	std::size_t                 index_for_time(float) const;
+	//!Same as get_for_time, returns the index of the frame.
 	std::size_t                 index_for_time(float, float) const;
 
 	//!Returns the number of frames in the animation.
@@ -86,18 +94,77 @@ class animation {
 	//!Returns the animation duration.
 	float				get_duration() const {return duration;}
 
+	//!Returns the ids of the events of the given frame as a range. Will
+	//!throw if the index is not valid.
+	std::pair<const std::uint32_t *, const std::uint32_t *> get_events(size_t) const;
+
 	private:
 
 	//!Calculates animation duration and adjusts starting time of each 
 	//!frame... I honestly don't know why anymore.
 	void				adjust_frame_time();
 
+	//!Returns the index of the first frame whose scaled end is not before
+	//!the given moment, or 0 if there is none. Takes the end times of the
+	//!frames, their count, the duration of the animation and whether the
+	//!end times are sorted, followed by the moment and the scaled duration.
+	static std::size_t		search(const float *, std::size_t, float, bool, float, float);
+
 	std::string			name;		//!< Animation name.
 	std::vector<animation_line>	data;		//!< Internal storage.
+	std::vector<float>		ends;		//!< Copy of each begin_time, packed for searching.
+	std::vector<std::uint32_t>	events;		//!< Event ids of all frames, in frame order.
 	float				duration;	//!< Calculated duration.
+	bool				sorted{true};	//!< False if a negative duration breaks the order of begin_time.
+	std::uint32_t			revision{0};	//!< Grows each time a reload replaces the animation.
 
 	friend class animation_table;
+	friend class animation_batch;
+	friend class animation_store;
+	friend class animation_handle;
+	friend class animation_player;
+
+};
+
+//!Frame indexes of an animation baked for every tick of a fixed timestep.
+
+//!Meant for fixed timestep games, where animations are always evaluated at
+//!multiples of the same tick: a lookup is then a single array read. The
+//!table covers one loop, so the animation duration (or the one given) must
+//!be a whole number of ticks. Tick i gives the same frame index_for_time
+//!does for the time i*tick, wrapped to the loop. The table keeps a pointer
+//!to the animation, which must outlive it, and must be built again if the
+//!animation changes (as in animation_table::reload).
+class animation_tick_table {
+
+	public:
+
+	//!Bakes the given animation with the given tick length. Will throw if
+	//!the duration is not a whole number of ticks.
+					animation_tick_table(const animation&, float);
+
+	//!Bakes the given animation as if it had the duration given by the third
+	//!parameter, as the rescaled get_for_time does. Will throw if the
+	//!duration is not a whole number of ticks.
+					animation_tick_table(const animation&, float, float);
+
+	//!Returns the index of the frame for the given tick.
+	std::size_t			index_for_tick(std::size_t _tick) const {return indexes[_tick % indexes.size()];}
+
+	//!Returns the frame for the given tick.
+	const animation_line&		get_for_tick(std::size_t _tick) const {return source->get(index_for_tick(_tick));}
+
+	//!Returns the number of ticks in a loop.
+	std::size_t			size() const {return indexes.size();}
 
+	//!Returns the tick length.
+	float				get_tick() const {return tick;}
+
+	private:
+
+	const animation *		source;		//!< Baked animation.
+	float				tick;		//!< Tick length.
+	std::vector<std::uint32_t>	indexes;	//!< Frame index for each tick.
 };
 
 //!Collection of indexed animations and their associated sprite table. Designed
@@ -113,32 +180,89 @@ class animation_table {
 	//!Class constructor, loads animation data.
 					animation_table(const sprite_table&, const std::string&);
 
-	//!Loads animation data from the given filename.
-	//TODO: Does not reset existing data!!!.
+	//!Class constructor, loads animation data compiled into the program.
+					animation_table(const sprite_table&, const embedded_animation_table&);
+
+	//!Loads animation data from the given filename, replacing the existing
+	//!data. The file is read in one go and each animation is timed once.
+	//!Nothing changes if the file cannot be loaded. Lines starting with @
+	//!name an event of the frame line above them (one per line).
 	void 				load(const std::string&);
 
-	//!Returns the animation at the given index. Will throw if the index is invalid.
-	const animation& 		get(size_t v) const {return data.at(v);}
+	//!Loads animation data compiled into the program (see asset_embedder.h),
+	//!replacing the existing data, without reading files. Nothing changes if
+	//!a frame is not in the sprite table.
+	void				load(const embedded_animation_table&);
 
 	//!Returns the animation at the given index. Will throw if the index is invalid.
-	animation			get(size_t v) {return data[v];}
+	const animation& 		get(size_t v) const {return data.at(v);}
 
 	//!Returns the sprite table.
 	const sprite_table&		get_table() const {return table;}
 
+	//!Returns the id of the event with the given name. Ids are kept for the
+	//!life of the table, through loads and reloads. Will throw
+	//!std::out_of_range if no file loaded had the event.
+	std::uint32_t			get_event_id(const std::string& _name) const {return event_ids.at(_name);}
+
+	//!Returns the name of the event with the given id. Will throw if the id
+	//!is invalid.
+	const std::string&		get_event_name(std::uint32_t _id) const {return event_names.at(_id);}
+
+	//!Returns the number of distinct events.
+	size_t				get_event_count() const {return event_names.size();}
+
 	//!Returns the quantity of animations in the internal storage.
-	size_t				size() {return data.size();}
+	size_t				size() const {return data.size();}
+
+	//!Returns the ids of all animations, sorted.
+	std::vector<size_t>		get_ids() const;
+
+	//!Loads the given file again and patches the animations that changed,
+	//!which keep their addresses. Nothing changes if the file cannot be
+	//!loaded, and the reload is refused with std::runtime_error if an
+	//!animation is no longer in the file, since it could still be referred
+	//!to. Returns the sorted ids of the animations that were added or
+	//!changed.
+	std::vector<size_t>		reload(const std::string&);
+
+	//!Copies again from the sprite table the frames with the given sorted
+	//!indexes, which must be called when the sprite table is reloaded. Will
+	//!throw, changing nothing, if a frame in use is no longer in the table.
+	//!Returns the number of lines updated.
+	size_t				refresh_frames(const std::vector<size_t>&);
+
+	//!Throws std::runtime_error if a frame in use is among the given sorted
+	//!indexes and is not in the given table, which is what refresh_frames
+	//!would do after reloading the sprite table into it. Meant to be used
+	//!as a sprite_table::reload_check.
+	void				check_frames(const sprite_table&, const std::vector<size_t>&) const;
 
 	private:
 
-	//!Reads animation header from line.
-	size_t				read_header(const std::string&);
+	//!Reads the animation id from a header line, without the leading mark.
+	static bool			parse_header(const char *, const char *, size_t&);
 
-	//!Reads animation data from line.
-	void				read_line(const std::string&, animation&);
+	//!Reads duration, frame index and optional flags from a frame line.
+	static bool			parse_line(const char *, const char *, int&, int&, int&);
+
+	//!Reads a number from the cursor, skipping leading whitespace.
+	template<typename T>
+	static bool			read_value(const char *&, const char *, T&);
+
+	//!Returns true if there is only whitespace left in the line.
+	static bool			at_end(const char *, const char *);
+
+	//!Returns the id of an event name, adding it if needed.
+	std::uint32_t			intern_event(const std::string&);
 
 	const sprite_table&		table;	//!< Reference to the sprite table.
 	std::map<size_t, animation>	data;	//!< Internal storage.
+	std::vector<std::string>	event_names;	//!< Event names by id.
+	std::map<std::string, std::uint32_t>	event_ids;	//!< Event ids by name.
+
+	friend class animation_batch;
+	friend class animation_store;
 };
 
 }
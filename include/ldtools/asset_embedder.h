@@ -0,0 +1,27 @@
+#pragma once
+
+#include "sprite_table.h"
+#include "animation_table.h"
+
+#include <ostream>
+#include <string>
+
+namespace ldtools {
+
+//!Writes a C++ header with the given sprite table as constexpr data, under
+//!the given name (an embedded_sprite_table), to the given stream. Will throw
+//!std::runtime_error if the name is not a valid identifier or an index does
+//!not fit in 32 bits.
+
+//!The sprite_table can then be built from the embedded data, which is
+//!copied without reading or parsing files. The asset_embedder utility and
+//!the CMake helpers in cmake/ldtools_embed.cmake use this.
+void embed_sprite_table(const sprite_table&, const std::string&, std::ostream&);
+
+//!Writes a C++ header with the given animation table as constexpr data,
+//!under the given name (an embedded_animation_table), to the given stream.
+//!Will throw std::runtime_error if the name is not a valid identifier or a
+//!frame duration is not finite.
+void embed_animation_table(const animation_table&, const std::string&, std::ostream&);
+
+}
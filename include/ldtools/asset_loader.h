@@ -0,0 +1,104 @@
+#pragma once
+
+#include "sprite_table.h"
+#include "animation_table.h"
+#include "ttf_manager.h"
+
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ldtools {
+
+//!Exception thrown by the asset loader.
+
+class asset_loader_exception:
+	public std::runtime_error {
+
+	public:
+	                asset_loader_exception(const std::string& _msg)
+		:std::runtime_error(_msg) {
+
+	}
+};
+
+//!Time spent loading a single asset.
+struct asset_load_time {
+
+	enum class kinds {sprite_table, animation_table, font};
+
+	kinds               kind;
+	std::string         id;             //!< Id in the manifest (alias for fonts).
+	std::string         path;           //!< File loaded.
+	double              milliseconds;   //!< Time spent loading.
+	bool                main_thread;    //!< True if it was loaded in the calling thread.
+};
+
+//!Loads the sprite tables, animation tables and fonts listed in a manifest
+//!file, parsing independent files in parallel.
+
+//!The manifest uses # to comment lines and whitespace to separate values.
+//!Each line is one of:
+//!sprite      id  path
+//!animation   id  path    sprite_id
+//!font        alias   size    path    [lazy]
+//!Sprite tables are loaded in worker threads and each animation table is
+//!loaded as soon as the sprite table it uses is ready. Fonts are created in
+//!the calling thread (SDL needs it) while the workers are busy, except for
+//!those marked lazy, which are only registered (see
+//!ttf_manager::insert_lazy) and can be warmed up afterwards with
+//!ttf_manager::warm_up_step, in this same thread. The loader
+//!owns the tables, so they live as long as it does.
+
+class asset_loader {
+
+	public:
+
+	//!Builds a loader that will use the given number of worker threads. Zero
+	//!means as many as the hardware supports.
+	                        asset_loader(std::size_t=0);
+
+	//!Loads everything in the manifest at the given path, inserting the fonts
+	//!in the ttf manager. Blocks until all is done. Will throw
+	//!asset_loader_exception if the manifest is invalid or any asset fails
+	//!to load, in which case the loaded tables are discarded.
+	void                    load(const std::string&, ttf_manager&);
+
+	//!Returns the sprite table with the given id. Will throw if it does not exist.
+	const sprite_table&     get_sprite_table(const std::string&) const;
+
+	//!Returns the animation table with the given id. Will throw if it does not exist.
+	const animation_table&  get_animation_table(const std::string&) const;
+
+	//!Returns the time each asset took in the last call to load, in
+	//!completion order.
+	const std::vector<asset_load_time>& get_load_times() const {return load_times;}
+
+	//!Returns the wall time of the last call to load in milliseconds.
+	double                  get_total_time() const {return total_time;}
+
+	private:
+
+	//!A line of the manifest.
+	struct entry {
+		asset_load_time::kinds      kind;
+		std::string                 id,
+		                            path,
+		                            dependency;
+		int                         size;
+		bool                        lazy;       //!< Fonts only: register without opening.
+	};
+
+	//!Reads the manifest at the given path.
+	std::vector<entry>      read_manifest(const std::string&) const;
+
+	std::size_t                                             threads;
+	std::map<std::string, std::unique_ptr<sprite_table>>    sprite_tables;
+	std::map<std::string, std::unique_ptr<animation_table>> animation_tables;
+	std::vector<asset_load_time>                            load_times;
+	double                                                  total_time{0.};
+};
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "sprite_table.h"
+#include "animation_table.h"
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ldtools {
+
+//!Exception thrown by the asset watcher.
+
+class asset_watcher_exception:
+	public std::runtime_error {
+
+	public:
+	                asset_watcher_exception(const std::string& _msg)
+		:std::runtime_error(_msg) {
+
+	}
+};
+
+//!Result of reloading a single file.
+struct asset_reload {
+
+	std::string         path;       //!< File reloaded.
+	bool                ok;         //!< False if the file could not be loaded.
+	std::string         error;      //!< Reason it could not be loaded.
+	std::size_t         changes;    //!< Frames or animations changed.
+};
+
+//!Watches the files of sprite and animation tables and reloads them in place
+//!when they change, so artists can work while the application is running.
+
+//!Uses inotify, so it is only available in Linux (it will throw when built
+//!anywhere else). The directories of the files are watched instead of the
+//!files themselves, so editors that save by replacing the file work too.
+//!Nothing happens until poll is called, which does not block and reparses
+//!only the files that changed. Sprite tables are patched in place (see
+//!sprite_table::reload) and the frames copied by the watched animation
+//!tables that use them are refreshed. A sprite table change that removes
+//!frames still used by those animations is refused, leaving all of them
+//!as they were, and so is an animation file that drops animations. Files
+//!are reloaded once written and closed or moved into place, never while
+//!they are still being written. The tables must outlive the watcher.
+
+class asset_watcher {
+
+	public:
+
+	//!Will throw asset_watcher_exception if inotify is not available.
+	                        asset_watcher();
+	                        ~asset_watcher();
+	                        asset_watcher(const asset_watcher&)=delete;
+	asset_watcher&          operator=(const asset_watcher&)=delete;
+
+	//!Watches the file the given sprite table was loaded from. Will throw if
+	//!the directory of the file cannot be watched.
+	void                    watch(sprite_table&, const std::string&);
+
+	//!Watches the file the given animation table was loaded from. Will throw
+	//!if the directory of the file cannot be watched.
+	void                    watch(animation_table&, const std::string&);
+
+	//!Reloads the files that changed since the last call. Does not block.
+	//!Files that fail to load are reported and left as they were.
+	std::vector<asset_reload> poll();
+
+	private:
+
+	//!A watched directory with the files of interest in it.
+	struct directory {
+		std::map<std::string, std::vector<sprite_table *>>      sprites;
+		std::map<std::string, std::vector<animation_table *>>   animations;
+		std::string                                             path;
+	};
+
+	//!Returns the watched directory that contains the given file path and
+	//!sets the second parameter to the file name.
+	directory&              directory_for(const std::string&, std::string&);
+
+	int                                 fd{-1};         //!< Inotify descriptor.
+	std::map<int, directory>            directories;    //!< By watch descriptor.
+	std::vector<animation_table *>      all_animations; //!< For frame refreshing.
+};
+
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "sprite_table.h"
+
+#include <SDL2/SDL.h>
+
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace ldtools {
+
+//!Exception thrown by the atlas packer.
+
+class atlas_packer_exception:
+	public std::runtime_error {
+
+	public:
+	                atlas_packer_exception(const std::string& _msg)
+		:std::runtime_error(_msg) {
+
+	}
+};
+
+//!Size of an atlas page, in pixels.
+struct atlas_page_size {
+	unsigned            w,
+	                    h;
+};
+
+//!Settings for the atlas packer.
+struct atlas_options {
+	//!Page sizes to try. The one that needs less memory in total wins.
+	std::vector<atlas_page_size>    page_sizes{{1024, 1024}};
+	//!Empty pixels between regions, against filtering bleed.
+	unsigned                        padding{0};
+	//!Merge frames with identical pixels (or identical boxes, when packing
+	//!without a surface).
+	bool                            deduplicate{true};
+};
+
+//!Where the frames of a sprite table go in an atlas.
+struct atlas_layout {
+
+	//!Same frames as the original table, with boxes in the atlas pages.
+	//!Displacements and flags are kept.
+	sprite_table                    table;
+	//!Atlas page of each frame index.
+	std::map<std::size_t, std::size_t> pages;
+	atlas_page_size                 page_size{0, 0};
+	std::size_t                     page_count{0},
+	                                regions{0},         //!< Regions actually packed.
+	                                duplicates{0},      //!< Frames that share a region with another one.
+	                                source_bytes{0},    //!< RGBA size of the source sheet.
+	                                atlas_bytes{0};     //!< RGBA size of all pages.
+
+	//!Returns the memory saved, which is negative if the atlas is larger.
+	long long                       saved_bytes() const {return (long long)source_bytes-(long long)atlas_bytes;}
+};
+
+//!Surface as returned by the atlas packer.
+using atlas_surface=std::unique_ptr<SDL_Surface, void(*)(SDL_Surface *)>;
+
+//!A packed atlas: layout plus the RGBA pages.
+struct atlas {
+	atlas_layout                    layout;
+	std::vector<atlas_surface>      pages;
+};
+
+//!Repacks the frames of a sprite table tightly into one or more atlas pages.
+
+//!Regions are sorted by height and placed with a skyline bottom-left
+//!heuristic. All page sizes in the options are tried and the one that needs
+//!less memory is kept. Frames with no size are left untouched. Can be used
+//!from code or through the sprite_atlas_packer utility.
+
+class atlas_packer {
+
+	public:
+
+	                        atlas_packer(const atlas_options&);
+
+	//!Computes the layout only, given the size of the source sheet. Frames
+	//!are deduplicated by box when the options ask for deduplication. Will
+	//!throw atlas_packer_exception if a frame does not fit in any page size.
+	atlas_layout            layout(const sprite_table&, unsigned, unsigned) const;
+
+	//!Packs the frames of the table, copying their pixels from the given
+	//!sheet into new RGBA pages. Frames are deduplicated by pixels when the
+	//!options ask for deduplication. Will throw atlas_packer_exception if a
+	//!frame falls outside the sheet or does not fit in any page size.
+	atlas                   pack(const sprite_table&, SDL_Surface *) const;
+
+	private:
+
+	//!A rectangle of the source sheet used by one or more frames.
+	struct region {
+		ldv::rect                   source;
+		std::vector<std::size_t>    frames;
+		std::size_t                 hash{0};
+		ldv::point                  position;   //!< Position in its page.
+		std::size_t                 page{0};
+	};
+
+	//!Groups the frames by box.
+	std::vector<region>     regions_for(const sprite_table&) const;
+
+	//!Places the regions in pages of the given size, returns the page count
+	//!or zero if a region is too large.
+	std::size_t             place(std::vector<region *>&, atlas_page_size) const;
+
+	//!Places the regions with the best page size and fills the layout.
+	atlas_layout            build(const sprite_table&, std::vector<region>&, std::size_t) const;
+
+	atlas_options           options;
+};
+
+}
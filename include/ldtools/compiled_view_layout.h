@@ -0,0 +1,136 @@
+#pragma once
+
+#include "mapped_file.h"
+#include "view_token.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace ldtools {
+
+//!Header of a compiled view layout file.
+
+//!Like compiled sprite tables, the format is mapped into memory and used as
+//!it is, so it is tied to the machine that wrote it. After the header come
+//!"layout_count" compiled_view_layout_entry sorted by name, "token_count"
+//!compiled_view_token, "string_count" compiled_view_string, the characters
+//!of all strings and "point_count" compiled_view_point, each block starting
+//!at its offset. Every distinct string is stored once and referenced by its
+//!index.
+
+struct compiled_view_layout_header {
+
+	static constexpr std::uint32_t magic_value=0x4c56444c; //!< "LDVL" in little endian.
+	static constexpr std::uint32_t version_value=1;
+	static constexpr std::uint32_t endianness_value=0x01020304;
+
+	std::uint32_t               magic,              //!< Must be magic_value.
+	                            version,            //!< Must be version_value.
+	                            endianness,         //!< Must read as endianness_value.
+	                            token_size,         //!< sizeof(compiled_view_token) of the writer.
+	                            layout_count,       //!< Number of layouts.
+	                            token_count,        //!< Number of tokens in all layouts.
+	                            string_count,       //!< Number of distinct strings.
+	                            point_count;        //!< Number of polygon points in all tokens.
+	std::uint64_t               layouts_offset,     //!< Offset to the layouts.
+	                            tokens_offset,      //!< Offset to the tokens.
+	                            strings_offset,     //!< Offset to the strings.
+	                            characters_offset,  //!< Offset to the characters of the strings.
+	                            characters_size,    //!< Size of the characters of the strings.
+	                            points_offset;      //!< Offset to the points.
+};
+
+//!A layout in a compiled file: its name and its range of tokens.
+struct compiled_view_layout_entry {
+
+	std::uint32_t               name,       //!< String index of the name.
+	                            first,      //!< First token.
+	                            count;      //!< Number of tokens.
+};
+
+//!A string in a compiled file, as a range of characters.
+struct compiled_view_string {
+
+	std::uint32_t               offset,     //!< Start in the characters.
+	                            size;       //!< Length in characters.
+};
+
+//!A polygon point in a compiled file.
+struct compiled_view_point {
+
+	std::int32_t                x, y;
+};
+
+//!A view_token in a compiled file, strings and points given by index.
+struct compiled_view_token {
+
+	static constexpr std::uint32_t no_string=0xffffffff; //!< Index of absent strings.
+
+	std::uint8_t                type,           //!< view_token::types value.
+	                            padding[3];     //!< Unused, zero.
+	std::uint32_t               flags;          //!< view_token::flags combination.
+	std::int32_t                order,
+	                            alpha,
+	                            rotation[3],
+	                            location[4],
+	                            clip[4],
+	                            brush[2],
+	                            rgba[4],
+	                            int_value;
+	float                       float_value;
+	double                      ratio;
+	std::uint32_t               id,             //!< String index or no_string.
+	                            resource,       //!< String index or no_string.
+	                            text,           //!< String index or no_string.
+	                            first_point,    //!< First point in the points.
+	                            point_count;    //!< Number of points.
+};
+
+//!Compiled view layout file, mapped into memory.
+
+//!Written by compile_view_layout and read by view_composer::parse. The whole
+//!file is checked when opened, so reading tokens afterwards does no checks,
+//!no string building and no allocations besides the polygon points.
+
+class compiled_view_layout {
+	public:
+
+	//!Maps and checks the file at the given path. Will throw
+	//!std::runtime_error if it cannot be read or is not a valid compiled
+	//!layout for this machine.
+	                            compiled_view_layout(const std::string&);
+
+	//!Returns the number of layouts.
+	std::size_t                 size() const {return header->layout_count;}
+
+	//!Returns true if there is a layout with the name.
+	bool                        has_layout(std::string_view) const;
+
+	//!Returns the first token of the named layout and the one past its last
+	//!token. Will throw std::runtime_error if there is no such layout.
+	std::pair<std::size_t, std::size_t> find(std::string_view) const;
+
+	//!Fills the token with the one at the index, its strings pointing into
+	//!the file. The index must be in a range returned by find.
+	void                        read(std::size_t, view_token&) const;
+
+	private:
+
+	//!Returns the layout with the name, or null.
+	const compiled_view_layout_entry * lookup(std::string_view) const;
+
+	//!Returns the string at the index, empty for no_string.
+	std::string_view            string(std::uint32_t) const;
+
+	mapped_file                 file;                   //!< Contents of the file.
+	const compiled_view_layout_header * header{nullptr};
+	const compiled_view_layout_entry *  layouts{nullptr};
+	const compiled_view_token *         tokens{nullptr};
+	const compiled_view_string *        strings{nullptr};
+	const char *                        characters{nullptr};
+	const compiled_view_point *         points{nullptr};
+};
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ldtools {
+
+//!Plain data compiled into a program by the asset_embedder utility, so
+//!sprite and animation tables can be built without reading files. See
+//!asset_embedder.h.
+
+//!A sprite frame, as in the text files.
+struct embedded_sprite_frame {
+	std::uint32_t           index;
+	int                     x,
+	                        y;
+	unsigned                w,
+	                        h;
+	int                     disp_x,
+	                        disp_y,
+	                        flags;
+};
+
+//!All frames of a sprite table, sorted by index.
+struct embedded_sprite_table {
+	const embedded_sprite_frame *   frames;
+	std::size_t                     count;
+};
+
+//!A frame of an animation.
+struct embedded_animation_line {
+	float                   duration;       //!< Seconds, as loaded.
+	std::uint32_t           frame,          //!< Index in the sprite table.
+	                        first_event,    //!< First of its events in the table.
+	                        event_count;
+	int                     flags;
+};
+
+//!An animation: a range of lines.
+struct embedded_animation {
+	std::uint32_t           id;
+	const char *            name;
+	std::uint32_t           first_line,
+	                        line_count;
+};
+
+//!All animations of an animation table, sorted by id.
+struct embedded_animation_table {
+	const embedded_animation *      animations;
+	std::size_t                     animation_count;
+	const embedded_animation_line * lines;
+	std::size_t                     line_count;
+	const char * const *            events;         //!< Event names of all lines.
+	std::size_t                     event_count;
+};
+
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "time_definitions.h"
+#include "time_source.h"
+#include "frame_stats.h"
 #include <chrono>
 
 namespace ldtools {
@@ -10,9 +12,12 @@ namespace ldtools {
 class fps_counter {
 	public:
 
-	//!Class constructor.
+	//!Class constructor, uses the real time.
 			fps_counter();
 
+	//!Class constructor, reads time from the given source, which must outlive the counter.
+			fps_counter(time_source&);
+
 	//!Returns the current frame count.
 	unsigned int 	get_frame_count() const {return frame_count;}
 		
@@ -22,21 +27,38 @@ class fps_counter {
 	//!Produces delta time elapsed, must be called when drawing is done.
 	tdelta		end_time_produce();
 
-	//!Counts frames, alse called after drawing is done.
+	//!Counts frames, alse called after drawing is done. The time since the
+	//!previous call is added to the frame statistics.
 	void 		loop_step();
 
-	//!Fills the first parameter with time until the second one is reached. A glorified and blocking "wait" or "sleep" 
+	//!Returns the durations of the last frames, as measured by loop_step.
+	const frame_stats&	get_frame_stats() const {return stats;}
+
+	//!Returns the frame statistics, to change their budget or clear them.
+	frame_stats&	get_frame_stats() {return stats;}
+
+	//!Fills the first parameter with time until the second one is reached. A glorified and blocking "wait" or "sleep",
+	//!which sleeps most of the time and only spins at the end (see frame_limiter).
 	void		fill_until(tdelta&, tdelta);
 
 	private:
 
-	typedef		std::chrono::high_resolution_clock t_clock;	//!< Internal clock.
+	typedef		time_source::time_point t_time_point;
 
-	t_clock::time_point	ticks_count,	//!< Marks the beginning of a count.
-				ticks_produce;	//!< Marks the beginning of a count to produce delta.
+	//!Returns the source in use.
+	time_source&	clock() {return source ? *source : real;}
+
+	real_time_source	real;		//!< Used when no source is given.
+	time_source *		source{nullptr};	//!< Given source, if any.
+
+	t_time_point		ticks_count,	//!< Marks the beginning of a count.
+				ticks_produce,	//!< Marks the beginning of a count to produce delta.
+				ticks_step;	//!< Marks the previous loop_step.
 
 	int 			frame_count,	//!< Live frame count.
 				internal_count;	//!< Mutable frame-count (will become live when a second elapses).
+
+	frame_stats		stats;		//!< Durations of the last frames.
 };
 
 }
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "time_definitions.h"
+
+#include <chrono>
+#include <cstddef>
+
+namespace ldtools {
+
+//!What a frame_limiter has been doing.
+struct frame_limiter_stats {
+
+	std::size_t         waits{0};           //!< Calls that waited.
+	double              sleep_seconds{0.},  //!< Time given back to the system.
+	                    spin_seconds{0.},   //!< Time spent spinning (a busy core).
+	                    error_sum{0.},      //!< Sum of wake up lateness, in seconds.
+	                    error_squares{0.},  //!< Sum of squared lateness.
+	                    max_error{0.};      //!< Worst lateness.
+
+	//!Mean wake up lateness, in seconds.
+	double              mean_error() const {return waits ? error_sum / waits : 0.;}
+
+	//!Standard deviation of the wake up lateness, in seconds.
+	double              jitter() const;
+};
+
+//!Waits for the end of each frame without keeping a core busy.
+
+//!Sleeps with clock_nanosleep (sleep_until when that is not available)
+//!until a margin before the deadline and spins only for that margin. The
+//!margin adapts to how late the system wakes the thread up: it grows fast
+//!when a sleep overshoots and shrinks slowly otherwise. Timing uses
+//!std::chrono::steady_clock with its full resolution.
+class frame_limiter {
+
+	public:
+
+	using                       clock=std::chrono::steady_clock;
+
+	//!Limits frames to the given duration, in seconds.
+	                            frame_limiter(tdelta=1. / 60.);
+
+	//!Sets the frame duration, in seconds.
+	void                        set_frame_time(tdelta);
+
+	//!Waits until the frame that started with the previous call has lasted
+	//!the frame duration and returns the time since that call, in seconds.
+	//!Frames that already took longer do not wait, and when far behind the
+	//!schedule starts again from now instead of rushing to catch up.
+	tdelta                      wait();
+
+	//!Waits the given time in seconds and returns the time actually waited.
+	tdelta                      wait_for(tdelta);
+
+	//!Waits until the given time.
+	void                        wait_until(clock::time_point);
+
+	//!Returns the current spin margin.
+	clock::duration             get_margin() const {return margin;}
+
+	const frame_limiter_stats&  get_stats() const {return stats;}
+	void                        reset_stats() {stats=frame_limiter_stats{};}
+
+	private:
+
+	//!Sleeps until the given time, or a bit later.
+	static void                 sleep_until(clock::time_point);
+
+	clock::duration             frame_time,
+	                            margin;
+	clock::time_point           deadline,       //!< End of the current frame.
+	                            last_wait;      //!< When the last frame ended.
+	frame_limiter_stats         stats;
+};
+
+}
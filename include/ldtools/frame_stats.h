@@ -0,0 +1,115 @@
+#pragma once
+
+#include "time_definitions.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace ldtools {
+
+//!Summary of the frames in a frame_stats window, in seconds.
+struct frame_stats_summary {
+
+	std::size_t         frames{0},      //!< Frames in the window.
+	                    hitches{0};     //!< Frames in the window over budget.
+	tdelta              min{0.},
+	                    max{0.},
+	                    mean{0.},
+	                    p50{0.},
+	                    p95{0.},
+	                    p99{0.};
+};
+
+//!Records frame durations over a rolling window.
+
+//!Durations go into a ring buffer and a log scale histogram that always
+//!describes the window, so adding one is a handful of operations and can be
+//!left on in production. Frames over the budget count as hitches. Summaries
+//!and percentiles are computed when asked for and are exact. Samples can be
+//!exported to CSV or to a binary file for offline analysis.
+class frame_stats {
+
+	public:
+
+	//!Histogram buckets per octave.
+	static const std::size_t    buckets_per_octave=4;
+	//!Number of histogram buckets. The first one takes everything below
+	//!its upper bound and the last one everything above its lower bound.
+	static const std::size_t    bucket_count=14 * buckets_per_octave;
+
+	//!Keeps the given number of frames, counting as hitches those longer
+	//!than the budget in seconds.
+	                            frame_stats(std::size_t=600, tdelta=1. / 60.);
+
+	//!Adds the duration of a frame, in seconds. Durations that are negative
+	//!or not finite (as floats) are ignored.
+	void                        add(tdelta);
+
+	//!Forgets all frames.
+	void                        clear();
+
+	//!Sets the budget and counts the hitches in the window again.
+	void                        set_budget(tdelta);
+	tdelta                      get_budget() const {return budget;}
+
+	//!Returns the number of frames in the window.
+	std::size_t                 size() const {return count;}
+	//!Returns the maximum number of frames in the window.
+	std::size_t                 get_window() const {return samples.size();}
+
+	//!Returns the number of frames over budget in the window.
+	std::size_t                 get_hitches() const {return hitches;}
+	//!Returns the number of frames added since construction or clear.
+	std::uint64_t               get_total_frames() const {return total_frames;}
+	//!Returns the number of frames over budget since construction or clear.
+	std::uint64_t               get_total_hitches() const {return total_hitches;}
+
+	//!Returns the mean frame duration of the window, or 0 if empty.
+	tdelta                      mean() const {return count ? sum / count : 0.;}
+
+	//!Returns the given percentile (0 to 100, others are clamped) of the
+	//!window, or 0 if empty. Will throw std::runtime_error for NaN.
+	tdelta                      percentile(double) const;
+
+	//!Returns minimum, maximum, mean and the 50th, 95th and 99th
+	//!percentiles of the window at once.
+	frame_stats_summary         summary() const;
+
+	//!Frames in the window in each bucket.
+	const std::vector<std::uint32_t>&   get_histogram() const {return histogram;}
+	//!Returns the lower bound of the given bucket, in seconds.
+	static tdelta               bucket_lower(std::size_t);
+	//!Returns the upper bound of the given bucket, in seconds.
+	static tdelta               bucket_upper(std::size_t _bucket) {return bucket_lower(_bucket+1);}
+
+	//!Returns the frames in the window, oldest first.
+	std::vector<float>          get_samples() const;
+
+	//!Writes the window as CSV, oldest frame first: a header and then the
+	//!frame number and the duration in seconds of each frame.
+	void                        write_csv(std::ostream&) const;
+
+	//!Writes the window in binary: "LDFS", a 32 bit version (1), a 32 bit
+	//!frame count, the budget as a 32 bit float and the durations as 32 bit
+	//!floats, oldest first, all in the byte order of the machine.
+	void                        write_binary(std::ostream&) const;
+
+	private:
+
+	//!Returns the histogram bucket for a duration.
+	static std::size_t          bucket(float);
+
+	std::vector<float>          samples;        //!< Ring buffer.
+	std::vector<std::uint32_t>  histogram;
+	mutable std::vector<float>  scratch;        //!< Sorting space for percentiles.
+	std::size_t                 next{0},        //!< Where the next frame goes.
+	                            count{0},
+	                            hitches{0};
+	std::uint64_t               total_frames{0},
+	                            total_hitches{0};
+	double                      sum{0.};
+	tdelta                      budget;
+};
+
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "time_definitions.h"
+#include "time_source.h"
+#include "frame_stats.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace ldtools {
+
+//!Runs a fixed timestep simulation under a free rendering rate.
+
+//!Each frame adds the time since the previous one to an accumulator and
+//!runs as many fixed steps as fit. The steps per frame are capped: when the
+//!simulation cannot keep up (a slow frame, a debugger pause) the time that
+//!does not fit is dropped and the game runs slower instead of spending more
+//!time catching up each frame, which would only make it fall further
+//!behind. What is left in the accumulator, as a fraction of the step, is
+//!the alpha to interpolate between the last two states when rendering.
+//!Frames can be limited to a rate, and frame and update durations are kept
+//!in frame_stats. Time is read from a time_source, the real one unless
+//!another is given.
+class loop_scheduler {
+
+	public:
+
+	//!Runs steps of the given duration in seconds, at most the given number
+	//!of them per frame. Frames are limited to the third parameter in
+	//!seconds, 0 meaning no limit. Will throw std::runtime_error if the step
+	//!is not positive or the maximum is 0.
+	                            loop_scheduler(tdelta=1. / 60., std::size_t=5, tdelta=0.);
+
+	//!Same as above, reading time from the given source, which must outlive
+	//!the scheduler.
+	                            loop_scheduler(time_source&, tdelta=1. / 60., std::size_t=5, tdelta=0.);
+
+	//!Runs a frame: calls the first parameter with the step duration once
+	//!for each step due and the second one with the interpolation alpha,
+	//!then waits for the frame limit if there is one. Returns the number of
+	//!steps run.
+	template<typename U, typename R>
+	std::size_t                 frame(U&&, R&&);
+
+	//!Adds the given seconds to the accumulator and takes the steps due,
+	//!dropping those over the maximum. Returns the number of steps to run.
+	//!Negative, infinite and NaN times count as 0. For loops that measure
+	//!time on their own, instead of frame().
+	std::size_t                 advance(tdelta);
+
+	//!Forgets the accumulated time and starts measuring from now.
+	void                        reset();
+
+	//!Returns the accumulated time as a fraction of the step, from 0 to 1.
+	tdelta                      get_alpha() const {return accumulator / step;}
+
+	tdelta                      get_step() const {return step;}
+	std::size_t                 get_max_steps() const {return max_steps;}
+	void                        set_max_steps(std::size_t);
+
+	//!Sets the frame limit in seconds, 0 meaning no limit.
+	void                        set_frame_time(tdelta);
+	tdelta                      get_frame_time() const {return frame_time;}
+
+	//!Returns the steps run since construction.
+	std::uint64_t               get_step_count() const {return steps;}
+	//!Returns the frames that hit the maximum number of steps.
+	std::uint64_t               get_dropped_frames() const {return dropped_frames;}
+	//!Returns the simulation time dropped, in seconds.
+	tdelta                      get_dropped_time() const {return dropped_time;}
+
+	//!Duration of each frame, as measured by frame().
+	const frame_stats&          get_frame_stats() const {return frames;}
+	frame_stats&                get_frame_stats() {return frames;}
+	//!Time spent running the steps of each frame, as measured by frame().
+	const frame_stats&          get_update_stats() const {return updates;}
+	frame_stats&                get_update_stats() {return updates;}
+
+	private:
+
+	//!Returns the source in use.
+	time_source&                clock() {return source ? *source : real;}
+
+	//!Waits for the end of the frame, keeping a fixed schedule unless more
+	//!than a frame behind.
+	void                        wait();
+
+	tdelta                      step,
+	                            accumulator{0.},
+	                            frame_time,
+	                            dropped_time{0.};
+	std::size_t                 max_steps;
+	std::uint64_t               steps{0},
+	                            dropped_frames{0};
+	real_time_source            real;           //!< Used when no source is given.
+	time_source *               source{nullptr};
+	time_source::time_point     last_frame,
+	                            deadline;       //!< End of the current frame.
+	frame_stats                 frames,
+	                            updates;
+};
+
+template<typename U, typename R>
+std::size_t loop_scheduler::frame(
+	U&& _update,
+	R&& _render
+) {
+
+	auto& time=clock();
+	const auto start=time.now();
+	const std::chrono::duration<tdelta> elapsed=start-last_frame;
+	last_frame=start;
+	frames.add(elapsed.count());
+
+	const std::size_t due=advance(elapsed.count());
+	for(std::size_t i=0; i<due; i++) {
+
+		_update(step);
+	}
+
+	updates.add(std::chrono::duration<tdelta>(time.now()-start).count());
+
+	_render(get_alpha());
+
+	if(frame_time > 0.) {
+
+		wait();
+	}
+
+	return due;
+}
+
+}
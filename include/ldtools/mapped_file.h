@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ldtools {
+
+//!Exception thrown by mapped_file.
+
+class mapped_file_exception:
+	public std::runtime_error {
+
+	public:
+	                mapped_file_exception(const std::string& _msg)
+		:std::runtime_error(_msg) {
+
+	}
+};
+
+//!Whole file available in memory.
+
+//!In POSIX systems the file is mapped read only, so all processes reading the
+//!same file share the same pages. Anywhere else the file is just read into a
+//!buffer. Either way the contents are only handed out as const. Not
+//!copyable: share it through a pointer if needed.
+
+class mapped_file {
+	public:
+
+	//!Maps the file at the given path. Will throw mapped_file_exception if
+	//!the file cannot be opened or mapped.
+	                        mapped_file(const std::string&);
+	                        ~mapped_file();
+	                        mapped_file(const mapped_file&)=delete;
+	mapped_file&            operator=(const mapped_file&)=delete;
+
+	//!Returns the beginning of the file contents. Null for empty files.
+	const char *            data() const {return begin;}
+
+	//!Returns the file size in bytes.
+	std::size_t             size() const {return length;}
+
+	private:
+
+	const char *            begin{nullptr};  //!< Start of the contents.
+	std::size_t             length{0};       //!< Size of the contents.
+	std::vector<char>       buffer;          //!< Storage when mapping is not available.
+};
+
+}
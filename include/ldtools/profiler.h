@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace ldtools {
+
+//!Zone profiler: records named spans of time per thread and writes them as
+//!Chrome trace events (to be opened in chrome://tracing or Perfetto).
+
+//!Zones are recorded when they end, into a buffer of the recording thread,
+//!so recording takes no locks. Nested zones show as nested spans. Buffers
+//!of finished threads are kept and handed to new threads, which then share
+//!their lane in the trace. Zones are usually opened through the
+//!LDTOOLS_PROFILE_ZONE macro, which expands to nothing unless
+//!LDTOOLS_PROFILER is defined (the BUILD_PROFILER cmake option defines it
+//!for the library).
+class profiler {
+
+	public:
+
+	//!Turns recording on or off at run time. On by default.
+	static void                 set_enabled(bool);
+	static bool                 is_enabled();
+
+	//!Returns nanoseconds since the profiler started, in steady_clock time.
+	static std::int64_t         now();
+
+	//!Records a zone of the calling thread, with its start and end as
+	//!returned by now(). The name is not copied and must outlive the
+	//!profiler, as string literals do.
+	static void                 record(const char *, std::int64_t, std::int64_t);
+
+	//!Names the calling thread in the trace.
+	static void                 set_thread_name(const std::string&);
+
+	//!Returns the number of zones recorded.
+	static std::size_t          get_zone_count();
+
+	//!Writes all zones as Chrome trace event JSON. Can be called while
+	//!other threads record: their last zones might be missing.
+	static void                 write_chrome_trace(std::ostream&);
+
+	//!Forgets all zones. No other thread may be recording.
+	static void                 clear();
+};
+
+//!Records a zone from construction to destruction.
+class profiler_zone {
+
+	public:
+
+	explicit                    profiler_zone(const char * _name)
+		:name(_name), begin(profiler::is_enabled() ? profiler::now() : -1) {}
+
+	                            ~profiler_zone() {
+
+		if(begin >= 0) {
+
+			profiler::record(name, begin, profiler::now());
+		}
+	}
+
+	                            profiler_zone(const profiler_zone&)=delete;
+	profiler_zone&              operator=(const profiler_zone&)=delete;
+
+	private:
+
+	const char *                name;
+	std::int64_t                begin;
+};
+
+}
+
+#define LDTOOLS_PROFILE_CONCAT_IMPL(_a, _b) _a##_b
+#define LDTOOLS_PROFILE_CONCAT(_a, _b) LDTOOLS_PROFILE_CONCAT_IMPL(_a, _b)
+
+#ifdef LDTOOLS_PROFILER
+
+//!Records a zone with the given name until the end of the scope.
+#define LDTOOLS_PROFILE_ZONE(_name) ldtools::profiler_zone LDTOOLS_PROFILE_CONCAT(ldtools_profiler_zone_, __LINE__){_name}
+//!Names the calling thread in the trace.
+#define LDTOOLS_PROFILE_THREAD(_name) ldtools::profiler::set_thread_name(_name)
+
+#else
+
+#define LDTOOLS_PROFILE_ZONE(_name) ((void)0)
+#define LDTOOLS_PROFILE_THREAD(_name) ((void)0)
+
+#endif
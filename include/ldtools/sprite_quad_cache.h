@@ -0,0 +1,70 @@
+#pragma once
+
+#include "sprite_table.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ldtools {
+
+//!Draw-ready quads for all frames of a sprite table.
+
+//!Each frame is resolved once: flip and rotation flags are applied to the
+//!texture coordinates, so that the corners of the destination quad (top
+//!left, top right, bottom right, bottom left) can be given the coordinates
+//!in the same order. Flips are applied first and then the clockwise
+//!rotation. Destination offsets come from the displacement and the
+//!extents are swapped for 90 and 270 degree rotations. Data is kept as
+//!structure of arrays, in index order, for batch renderers. The cache is a
+//!snapshot: build it again if the table changes.
+
+class sprite_quad_cache {
+
+	public:
+
+	//!Empty cache.
+	                        sprite_quad_cache();
+
+	//!Builds the cache for the given table, using the texture size to
+	//!normalize the coordinates.
+	                        sprite_quad_cache(const sprite_table&, unsigned, unsigned);
+
+	//!Rebuilds the cache for the given table and texture size.
+	void                    build(const sprite_table&, unsigned, unsigned);
+
+	//!Returns the number of quads.
+	std::size_t             size() const {return indexes.size();}
+
+	//!Returns the slot of the quad for the given frame index. Will throw
+	//!sprite_table_exception if the index is not cached.
+	std::size_t             slot(std::size_t) const;
+
+	//!Returns true if the given frame index is cached.
+	bool                    exists(std::size_t) const;
+
+	//!Frame index of each slot.
+	const std::vector<std::uint32_t>&   get_indexes() const {return indexes;}
+	//!Texture coordinates, four u,v pairs per slot (eight floats), to be
+	//!used for the top left, top right, bottom right and bottom left
+	//!corners of the destination.
+	const std::vector<float>&           get_uvs() const {return uvs;}
+	//!Destination offset from the drawing position, horizontal.
+	const std::vector<float>&           get_offsets_x() const {return offsets_x;}
+	//!Destination offset from the drawing position, vertical.
+	const std::vector<float>&           get_offsets_y() const {return offsets_y;}
+	//!Destination width, after rotation.
+	const std::vector<float>&           get_widths() const {return widths;}
+	//!Destination height, after rotation.
+	const std::vector<float>&           get_heights() const {return heights;}
+
+	private:
+
+	std::vector<std::uint32_t>  indexes;    //!< Sorted frame indexes.
+	std::vector<float>          uvs,
+	                            offsets_x,
+	                            offsets_y,
+	                            widths,
+	                            heights;
+};
+
+}
@@ -6,8 +6,16 @@
 //Tools deps.
 #include <tools/text_reader.h>
 
+#include "embedded_assets.h"
+
+#include <cstdint>
 #include <fstream>
+#include <functional>
+#include <iterator>
 #include <map>
+#include <memory>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace ldtools {
@@ -43,6 +51,9 @@ struct sprite_frame {
 	//!Can be used to check that the sprite has been loaded. Will discard
 	//!unitialized sprites.
 	explicit operator bool() const {return box.origin.x || box.origin.y || box.w || box.h || disp_x || disp_y;}
+
+	bool            operator==(const sprite_frame& _o) const {return box==_o.box && disp_x==_o.disp_x && disp_y==_o.disp_y && flags==_o.flags;}
+	bool            operator!=(const sprite_frame& _o) const {return !(*this==_o);}
 };
 
 //!Exception thrown by the sprite_table.
@@ -57,6 +68,90 @@ class sprite_table_exception:
 	}
 };
 
+class mapped_file;
+
+//!Iterator for the sprite table. Walks either a map or a flat array of
+//!entries of the same type as the map's, so both hand out real references.
+
+template<typename V, typename M>
+class sprite_table_iterator {
+	public:
+
+	using iterator_category=std::bidirectional_iterator_tag;
+	using value_type=typename std::remove_const<V>::type;
+	using difference_type=std::ptrdiff_t;
+	using pointer=V *;
+	using reference=V&;
+
+	                        sprite_table_iterator(M _it)
+		:map_it(_it) {}
+
+	                        sprite_table_iterator(V * _entry)
+		:entry(_entry) {}
+
+	//!Conversion from the non-const iterator.
+	template<typename OV, typename OM>
+	                        sprite_table_iterator(const sprite_table_iterator<OV, OM>& _other)
+		:map_it(_other.map_it), entry(_other.entry) {}
+
+	reference               operator*() const {return entry ? *entry : *map_it;}
+	pointer                 operator->() const {return &(**this);}
+
+	sprite_table_iterator&  operator++() {
+
+		if(entry) {
+			++entry;
+		}
+		else {
+			++map_it;
+		}
+
+		return *this;
+	}
+
+	sprite_table_iterator&  operator--() {
+
+		if(entry) {
+			--entry;
+		}
+		else {
+			--map_it;
+		}
+
+		return *this;
+	}
+
+	sprite_table_iterator   operator++(int) {
+
+		sprite_table_iterator result{*this};
+		++(*this);
+		return result;
+	}
+
+	sprite_table_iterator   operator--(int) {
+
+		sprite_table_iterator result{*this};
+		--(*this);
+		return result;
+	}
+
+	bool                    operator==(const sprite_table_iterator& _other) const {
+
+		return entry || _other.entry
+			? entry==_other.entry
+			: map_it==_other.map_it;
+	}
+
+	bool                    operator!=(const sprite_table_iterator& _other) const {return !(*this==_other);}
+
+	private:
+
+	M                       map_it{};       //!< Position in map storage.
+	V *                     entry{nullptr}; //!< Position in flat storage.
+
+	template<typename OV, typename OM> friend class sprite_table_iterator;
+};
+
 //!Alpha and resource agnostic sprite table: contains a collection of sprite
 //!frames loaded from a file with a specific format.
 
@@ -69,27 +164,89 @@ class sprite_table_exception:
 //!to write the format is something else's responsibility, so no insert, update
 //!or delete.
 //!Flags are optional in the file, as they were added later.
+//!Tables can also be loaded from a compiled binary file (see
+//!sprite_table_compiler.h). These are mapped into memory and read in place,
+//!so processes using the same file share its pages. The mapping is read only:
+//!compiled tables must be walked through const iterators.
 
 class sprite_table {
 	public:
 
 	using container=std::map<size_t, sprite_frame>;
-	using iterator=typename container::iterator;
-	using const_iterator=typename container::const_iterator;
+	using iterator=sprite_table_iterator<container::value_type, container::iterator>;
+	using const_iterator=sprite_table_iterator<const container::value_type, container::const_iterator>;
+
+	//!Where the frames are kept.
+	enum class storage {
+		map,        //!< Regular map, filled from text files.
+		dense,      //!< Paged flat arrays filled from text files, O(1) lookups.
+		compiled    //!< Compiled file mapped into memory.
+	};
 
 	//!Initializes the table with the file at the given path. Will throw
 	//!std::runtime error if the file cannot be found or has an invalid
 	//!format.
 	                        sprite_table(const std::string&);
 
+	//!Initializes the table with the file at the given path, keeping its
+	//!frames in the given storage (map or dense). Will throw as load does.
+	                        sprite_table(const std::string&, storage);
+
 	//!Default constructor, builds an empty sprite table.
 	                        sprite_table();
 
+	//!Builds an empty sprite table that will keep the frames of text files in
+	//!the given storage (map or dense). Will throw sprite_table_exception
+	//!with the compiled storage, that one is chosen by load_compiled.
+	explicit                sprite_table(storage);
+
+	//!Builds a sprite table with the given frames, kept in the given storage
+	//!(map or dense). Meant for tools that produce tables, like the atlas
+	//!packer. Will throw sprite_table_exception as the constructor above.
+	explicit                sprite_table(const container&, storage=storage::map);
+
+	//!Builds the table from data compiled into the program (see
+	//!asset_embedder.h), without reading files. Will throw
+	//!sprite_table_exception with compiled storage.
+	explicit                sprite_table(const embedded_sprite_table&, storage=storage::map);
+
+	                        sprite_table(const sprite_table&)=default;
+	                        sprite_table(sprite_table&&)=default;
+	sprite_table&           operator=(const sprite_table&);
+	sprite_table&           operator=(sprite_table&&)=default;
+
 	//!Loads/reloads the table with the given file path. Will throw with
 	//!std::runtime_error if the file cannot be found or has an invalid
 	//!format.On failure, the data is guaranteed to be empty.
 	sprite_table&           load(const std::string&);
 
+	//!Loads the table from the compiled file at the given path, mapping it
+	//!into memory instead of copying it. Will throw sprite_table_exception if
+	//!the file cannot be found or was not compiled for this machine and
+	//!library version. On failure, the data is guaranteed to be empty.
+	sprite_table&           load_compiled(const std::string&);
+
+	//!Loads the file at the given path again (text or compiled, as the last
+	//!load) and patches the differences into the table, which is left as it
+	//!was if the file cannot be loaded. Returns the sorted indexes that were
+	//!added, changed or removed. Frames that did not change keep their
+	//!addresses when the storage is a map, or when the indexes did not change
+	//!in the dense storage. Meant for hot reloading.
+	std::vector<size_t>     reload(const std::string& _path) {return reload(_path, {});}
+
+	//!Checks a reload before it patches anything: receives the table as read
+	//!from the file and the sorted indexes that would change.
+	typedef std::function<void(const sprite_table&, const std::vector<size_t>&)> reload_check;
+
+	//!Same as reload, calling the check (if any) once the file is read. If
+	//!the check throws the exception is passed along and the table is left
+	//!as it was, so the users of the table can refuse changes they cannot
+	//!take (see animation_table::check_frames).
+	std::vector<size_t>     reload(const std::string&, const reload_check&);
+
+	//!Returns the storage currently in use.
+	storage                 get_storage() const {return current_storage;}
+
 	//!Returns the frame at the given index. Will throw if the index is invalid.
 	const sprite_frame&     get(size_t) const;
 
@@ -97,22 +254,70 @@ class sprite_table {
 	bool                    exists(size_t) const;
 
 	//!Returns the size of the table.
-	size_t                  size() const {return data.size();}
+	size_t                  size() const;
 
-	//!Implementation of an iterator using the underlying map: the easiest way.
-	iterator                begin() {return data.begin();}
-	iterator                end() {return data.end();}
-	const_iterator          begin() const {return data.begin();}
-	const_iterator          end() const {return data.end();}
+	//!Iterators walk the frames in index order, whatever the storage. The
+	//!non-const ones will throw sprite_table_exception with the compiled
+	//!storage, which is read only (use std::as_const or cbegin).
+	iterator                begin();
+	iterator                end();
+	const_iterator          begin() const;
+	const_iterator          end() const;
 
 	private:
 
+	//!Number of frame indexes covered by each page of the dense storage.
+	static constexpr size_t dense_page_size=256;
+	//!Marks absent pages and frames in the dense storage.
+	static constexpr std::uint32_t dense_none=0xffffffff;
+
+	//!Drops all data in all storages.
+	void                    reset();
+
+	//!Reads a frame line between the two pointers into the index and frame.
+	//!Returns false if the line is malformed.
+	static bool             parse_line(const char *, const char *, size_t&, sprite_frame&);
+
+	//!Skips whitespace and reads a number, advancing the cursor. Returns
+	//!false if no number can be read.
+	template<typename T>
+	static bool             read_value(const char *&, const char *, T&);
+
+	//!Stores the given frames, which are in file order, in the current
+	//!storage. Existing frames win over new ones with the same index.
+	void                    store(std::vector<std::pair<size_t, sprite_frame>>&);
+
+	//!Returns the position of the index in the flat keys and frames, or the
+	//!flat count if it cannot be found.
+	size_t                  flat_position(size_t) const;
+
+	//!Flat storage entries: the dense vector or the mapped compiled file.
+	const container::value_type * flat_entries() const;
+	//!Returns the dense entries for the non-const iterators. Will throw
+	//!sprite_table_exception with the compiled storage.
+	container::value_type * dense_mutable_entries();
+	size_t                  flat_count() const;
+
 	//! Internal data storage.is interpreted in terms of a map to enable skips
 	//! in the indexes content (such as frames 0-60 being scenery, 100-140
 	//! items...).
 
 	container  data;
 
+	//!The dense storage keeps the same skips: frames and their indexes are
+	//!kept in index order in an array of the map's entries, and each page of
+	//!indexes that holds at least one frame is a block of positions in this
+	//!array. The directory points each page to its block, so unused ranges
+	//!cost 4 bytes per page.
+
+	std::vector<container::value_type> dense_entries;   //!< Indexes and frames, sorted.
+	std::vector<std::uint32_t>      dense_directory;    //!< Page to block, or dense_none.
+	std::vector<std::uint32_t>      dense_blocks;       //!< Positions, dense_page_size per block.
+
+	storage                         current_storage{storage::map},
+	                                text_storage{storage::map};  //!< Storage for text files.
+	std::shared_ptr<mapped_file>    compiled;       //!< Mapped file for the compiled storage.
+	size_t                          compiled_count{0};
 };
 
 }
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "sprite_table.h"
+
+#include <cstdint>
+#include <string>
+
+namespace ldtools {
+
+//!Header of a compiled sprite table file.
+
+//!The compiled format is meant to be mapped into memory and used as it is, so
+//!it is tied to the machine that wrote it (endianness and frame layout are
+//!checked when loading). After the header come "count" entries of the
+//!sprite table map (std::pair of index and sprite_frame), sorted by index and
+//!starting at "entries_offset", so iterators can point straight into them.
+
+struct compiled_sprite_table_header {
+
+	static constexpr std::uint32_t magic_value=0x5453444c; //!< "LDST" in little endian.
+	static constexpr std::uint32_t version_value=1;
+	static constexpr std::uint32_t endianness_value=0x01020304;
+
+	std::uint32_t               magic,          //!< Must be magic_value.
+	                            version,        //!< Must be version_value.
+	                            endianness,     //!< Must read as endianness_value.
+	                            entry_size;     //!< sizeof(sprite_table::container::value_type) of the writer.
+	std::uint64_t               count,          //!< Number of frames.
+	                            entries_offset; //!< Offset to the entries.
+};
+
+//!Writes the given sprite table in the compiled format to the given path.
+//!Will throw sprite_table_exception if the file cannot be written.
+
+//!The sprite table stays read-only by design, so writing compiled files is
+//!done here.
+void compile_sprite_table(const sprite_table&, const std::string&);
+
+//!Converts the sprite table text file in the first path to a compiled file
+//!in the second one. Will throw sprite_table_exception on failure.
+void compile_sprite_table(const std::string&, const std::string&);
+
+}
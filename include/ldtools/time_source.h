@@ -0,0 +1,113 @@
+#pragma once
+
+#include "time_definitions.h"
+#include "frame_limiter.h"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ldtools {
+
+//!Where timed classes (fps_counter, loop_scheduler) read the time from and
+//!how they wait for it, so that tests and replays can run on time that is
+//!not the real one.
+class time_source {
+
+	public:
+
+	using                       time_point=std::chrono::steady_clock::time_point;
+	using                       duration=std::chrono::steady_clock::duration;
+
+	virtual                     ~time_source() {}
+
+	//!Returns the current time.
+	virtual time_point          now()=0;
+
+	//!Waits until the given time.
+	virtual void                wait_until(time_point)=0;
+};
+
+//!The real time, from std::chrono::steady_clock. Waits with a frame_limiter.
+class real_time_source:
+	public time_source {
+
+	public:
+
+	time_point                  now() override {return std::chrono::steady_clock::now();}
+	void                        wait_until(time_point _time) override {limiter.wait_until(_time);}
+
+	const frame_limiter&        get_limiter() const {return limiter;}
+
+	private:
+
+	frame_limiter               limiter;
+};
+
+//!Time that only moves when told to. Waiting moves it to the time waited
+//!for, without blocking.
+class manual_time_source:
+	public time_source {
+
+	public:
+
+	time_point                  now() override {return current;}
+	void                        wait_until(time_point _time) override;
+
+	//!Moves the time forward the given seconds.
+	void                        advance(tdelta);
+
+	//!Sets the time.
+	void                        set(time_point _time) {current=_time;}
+
+	private:
+
+	time_point                  current{};
+};
+
+//!Time of a recorded session, frame by frame (see timing_recorder). Time
+//!only moves when next_frame is called. Waiting does nothing, since the
+//!recorded durations include whatever the session waited.
+class recorded_time_source:
+	public time_source {
+
+	public:
+
+	//!Plays the given frame durations, in seconds.
+	explicit                    recorded_time_source(const std::vector<tdelta>&);
+
+	//!Plays the frame durations saved in the given file by
+	//!timing_recorder::save. Will throw std::runtime_error if the file
+	//!cannot be read.
+	explicit                    recorded_time_source(const std::string&);
+
+	time_point                  now() override {return current;}
+	void                        wait_until(time_point) override {}
+
+	//!Moves the time to the end of the next frame. Returns false, without
+	//!moving it, when there are no frames left.
+	bool                        next_frame();
+
+	//!Goes back to before the first frame.
+	void                        rewind();
+
+	//!Returns the duration of the last frame played, in seconds.
+	tdelta                      get_delta() const {return frame ? deltas[frame-1] : 0.;}
+
+	//!Returns the number of frames played.
+	std::size_t                 get_frame() const {return frame;}
+
+	//!Returns the number of frames recorded.
+	std::size_t                 size() const {return deltas.size();}
+
+	const std::vector<tdelta>&  get_deltas() const {return deltas;}
+
+	private:
+
+	std::vector<tdelta>         deltas;
+	std::size_t                 frame{0};
+	time_point                  current{};
+};
+
+}
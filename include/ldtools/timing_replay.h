@@ -0,0 +1,103 @@
+#pragma once
+
+#include "time_definitions.h"
+#include "time_source.h"
+#include "frame_stats.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace ldtools {
+
+//!Records the duration of each frame of a session, to be replayed with a
+//!recorded_time_source.
+class timing_recorder {
+
+	public:
+
+	//!Records frames as seen by the given source, which must outlive the
+	//!recorder. Time starts counting now.
+	explicit                    timing_recorder(time_source&);
+
+	//!Ends a frame, recording the time since the previous one.
+	void                        frame();
+
+	const std::vector<tdelta>&  get_deltas() const {return deltas;}
+
+	//!Saves the durations to a text file, one per line in hexadecimal
+	//!floating point so that they are read back exactly. Will throw
+	//!std::runtime_error if the file cannot be written.
+	void                        save(const std::string&) const;
+
+	//!Reads durations saved by save. Will throw std::runtime_error if the
+	//!file cannot be read or has something that is not a duration.
+	static std::vector<tdelta>  load(const std::string&);
+
+	private:
+
+	time_source&                source;
+	time_source::time_point     last;
+	std::vector<tdelta>         deltas;
+};
+
+//!Replays a recorded session headlessly, measuring the processor time each
+//!frame takes, so that two builds can be compared frame by frame under the
+//!same timing.
+class timing_replay {
+
+	public:
+
+	//!Replays the given source, which must outlive the replay.
+	explicit                    timing_replay(recorded_time_source&);
+
+	//!Rewinds the source and calls the parameter with the duration of each
+	//!frame, after moving the source to the end of that frame. Code under
+	//!test should read the time from the source. Returns the number of
+	//!frames run.
+	template<typename F>
+	std::size_t                 run(F&&);
+
+	//!Returns the processor time of each frame in the last run, in
+	//!nanoseconds.
+	const std::vector<std::int64_t>&    get_costs() const {return costs;}
+
+	//!Returns the processor time of the frames in the last run, in seconds.
+	frame_stats                 get_cost_stats() const;
+
+	//!Writes the last run as CSV: frame number, frame duration in seconds
+	//!and processor time in nanoseconds.
+	void                        write_csv(std::ostream&) const;
+
+	//!Returns the processor time used by the calling thread, in
+	//!nanoseconds (wall time where that is not available).
+	static std::int64_t         cpu_now();
+
+	private:
+
+	recorded_time_source&       source;
+	std::vector<std::int64_t>   costs;
+};
+
+template<typename F>
+std::size_t timing_replay::run(
+	F&& _frame
+) {
+
+	source.rewind();
+	costs.clear();
+	costs.reserve(source.size());
+
+	while(source.next_frame()) {
+
+		const auto start=cpu_now();
+		_frame(source.get_delta());
+		costs.push_back(cpu_now()-start);
+	}
+
+	return costs.size();
+}
+
+}
@@ -2,11 +2,26 @@
 
 #include <ldv/ttf_font.h>
 
+#include "time_definitions.h"
+
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
+#include <vector>
 
 namespace ldtools {
 
+//!Memory use of a ttf_manager.
+struct ttf_manager_stats {
+
+	std::size_t         footprint{0},   //!< Bytes of the open fonts.
+	                    open{0};        //!< Open fonts.
+	std::uint64_t       evictions{0},   //!< Fonts closed to fit the budget.
+	                    reloads{0};     //!< Fonts opened again after being closed.
+};
+
 /*
 Un gestor de data ttf. Almacena una clave de texto o y un entero con una fuente
 ttf y un sizeaño. Se trabaja en dos pasos:
@@ -24,22 +39,114 @@ En caso de no existir la fuente se lanzará un std::runtime_error.
 //!the libdansdl2 font data. There are two steps to using the class: first
 //!register the font with insert("alias", size, ttf_font path) and then
 //!getting it with get("alias", size").
+//!
+//!Fonts registered with insert_lazy are only opened by the first get, or
+//!ahead of time by warm_up_step. SDL_ttf must be used from the thread that
+//!renders, so fonts are never opened in the background: call warm_up_step
+//!once per frame with the time that can be spared until it returns false.
+//!For the same reason the manager is not thread safe and must only be used
+//!from that thread.
+//!
+//!Each registered pair gets an integer handle (get_handle) that finds the
+//!font without building strings or searching: resolve it once and keep it.
+//!Handles are never reused, so the handle of an erased font stays invalid.
+//!Paths are kept once however many sizes use them, but each size still
+//!opens its file, since ldv::ttf_font only opens fonts by path.
+//!
+//!With a memory budget (set_budget), opening a font closes the least
+//!recently used fonts that are not pinned until the open ones fit, and a
+//!closed font is opened again by its next get. A font counts as many bytes
+//!as its file has. References returned by get are then only valid until
+//!the next get or insert: whatever keeps a font, such as a view_composer or
+//!the texts of a ttf_text_cache, holds a font_ref from acquire instead,
+//!which keeps it open for as long as any copy of it lives.
 
 class ttf_manager {
+	private:
+
+	struct font_entry;
+
 	public:
 
-	//!Returs the stored font with the alias and size. Will throw std::runtime_error if the font is not registered in the given size.
+	//!Class constructor.
+							ttf_manager()=default;
+
+							ttf_manager(const ttf_manager&)=delete;
+	ttf_manager&					operator=(const ttf_manager&)=delete;
+
+	//!Integer handle to a registered font.
+	typedef std::uint32_t				handle;
+
+	//!Counted reference to an open font, which is not closed to fit the
+	//!budget while a copy lives. Must not outlive the manager, and the font
+	//!cannot be erased meanwhile.
+	class font_ref {
+		public:
+
+		//!Builds an empty reference.
+						font_ref()=default;
+						font_ref(const font_ref&);
+						font_ref(font_ref&&) noexcept;
+						~font_ref();
+		font_ref&			operator=(font_ref);
+
+		//!Returns the font. Must not be empty.
+		const ldv::ttf_font&		operator*() const {return *entry->font;}
+		const ldv::ttf_font *		operator->() const {return entry->font.get();}
+		//!Returns true if it refers to a font.
+		explicit			operator bool() const {return nullptr!=entry;}
+
+		private:
+
+		explicit			font_ref(const font_entry&);
+
+		const font_entry *		entry{nullptr};	//!< Held entry, if any.
+
+		friend class ttf_manager;
+	};
+
+	//!Returs the stored font with the alias and size, opening it if it was registered lazily. Will throw std::runtime_error if the font is not registered in the given size or cannot be opened.
 	const ldv::ttf_font&				get(const std::string&, int) const;
+	//!Returs the stored font with the handle, opening it if it was registered lazily. Will throw std::runtime_error if the handle is invalid or the font cannot be opened.
+	const ldv::ttf_font&				get(handle) const;
+	//!Same as get, but the font stays open while the returned reference or a copy lives. Will throw as get does.
+	font_ref					acquire(const std::string&, int) const;
+	//!Same as get, but the font stays open while the returned reference or a copy lives. Will throw as get does.
+	font_ref					acquire(handle) const;
+	//!Returns the handle of the font with the alias and size. Will throw std::runtime_error if the font is not registered in the given size.
+	handle						get_handle(const std::string&, int) const;
 	//!Inserts a font with the given alias and size using the path to the ttf file. Returns false if the font was already inserted.
 	bool						insert(const std::string&, int, const std::string&);
+	//!Registers a font with the given alias and size and the path to the ttf file, without opening it. Returns false if the font was already inserted.
+	bool						insert_lazy(const std::string&, int, const std::string&);
 	//!Returns true if the font with the given alias and size exists.
 	bool						exists(const std::string&, int) const;
-	//!Erases the font with the given alias and size. Will throw if the font is not registered.
+	//!Returns true if the handle belongs to a registered font.
+	bool						exists(handle _handle) const {return _handle < handles.size() && handles[_handle];}
+	//!Returns true if the font with the given alias and size exists and is open, so get will not open it.
+	bool						is_ready(const std::string&, int) const;
+	//!Returns true if all fonts are open.
+	bool						is_ready() const;
+	//!Opens fonts registered lazily in the calling thread until the given time in seconds is spent, at least one per call. Fonts that fail to open are left for get to report, and none are opened once the budget is full. Returns true if there are fonts left to open.
+	bool						warm_up_step(tdelta);
+	//!Erases the font with the given alias and size. Will throw if the font is not registered or a font_ref holds it.
 	void						erase(const std::string&, int);
-	//!Clears all memory
+	//!Clears all memory. Will throw if a font_ref holds any font.
 	void                        clear();
-	//!Returns the amount of loaded pairs of font-size
+	//!Returns the amount of registered pairs of font-size
 	std::size_t                 size() const {return data.size();}
+	//!Returns the amount of open pairs of font-size
+	std::size_t                 loaded_size() const;
+	//!Sets the memory budget in bytes, 0 meaning none, closing fonts as needed.
+	void						set_budget(std::size_t);
+	//!Returns the memory budget in bytes, 0 meaning none.
+	std::size_t					get_budget() const {return budget;}
+	//!Pins or unpins the font with the handle: pinned fonts are never closed to fit the budget. Will throw std::runtime_error if the handle is invalid.
+	void						set_pinned(handle, bool);
+	//!Returns true if the font with the handle is pinned or held by a font_ref. Will throw std::runtime_error if the handle is invalid.
+	bool						is_pinned(handle) const;
+	//!Returns the current footprint and eviction counts.
+	ttf_manager_stats				get_stats() const;
 
 	private:
 
@@ -56,7 +163,45 @@ class ttf_manager {
 		}
 	};
 
-	std::map<font_info, ldv::ttf_font>	data;		//!< Internal data storage
+	//!A registered font, open or not.
+	struct font_entry {
+		const std::string * path{nullptr};		//!< Path to the ttf file, in paths.
+		int size;					//!< Font size in px.
+		handle id;					//!< Handle of the font.
+		mutable std::unique_ptr<ldv::ttf_font> font;	//!< Open font, if any.
+		mutable bool ready{false};			//!< Set once the font is open.
+		mutable std::uint64_t last_use{0};		//!< When it was last asked for.
+		mutable std::size_t bytes{0};			//!< Counted against the budget while open.
+		mutable bool evicted{false};			//!< Closed to fit the budget.
+		mutable bool failed{false};			//!< Failed to open in a warm up.
+		bool pinned{false};				//!< Never closed to fit the budget.
+		mutable std::size_t refs{0};			//!< Live font_ref copies, never closed meanwhile.
+	};
+
+	//!Marks the entry as used and returns its font, opening it if needed.
+	const ldv::ttf_font&				use(const font_entry&) const;
+
+	//!Returns the entry of the handle. Will throw if the handle is invalid.
+	font_entry&					entry_for(handle) const;
+
+	//!Closes the least recently used unpinned fonts, but the given one,
+	//!until the open fonts fit the budget.
+	void						trim(const font_entry *) const;
+
+	//!Adds an entry for the alias, size and path, without opening it.
+	font_entry&					add(const std::string&, int, const std::string&);
+
+	//!Opens the font of the entry, if not open. Closes others to fit the budget if told to.
+	void						open(const font_entry&, bool=true) const;
+
+	std::map<font_info, font_entry>	data;		//!< Internal data storage
+	std::vector<font_entry *>			handles;	//!< Entries by handle, null once erased.
+	std::set<std::string>				paths;		//!< Paths of all fonts, once each.
+	std::size_t					budget{0};	//!< Memory budget, 0 for none.
+	mutable std::size_t				footprint{0};	//!< Bytes of the open fonts.
+	mutable std::uint64_t				use_clock{0},	//!< Orders uses for eviction.
+							evictions{0},	//!< Fonts closed to fit the budget.
+							reloads{0};	//!< Fonts opened again after being closed.
 };
 
 }
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "ttf_manager.h"
+
+#include <ldv/ttf_representation.h>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace ldtools {
+
+//!Counters of a ttf_text_cache.
+struct ttf_text_cache_stats {
+
+	std::uint64_t       hits{0},
+	                    misses{0},
+	                    evictions{0};
+};
+
+//!Keeps rendered texts so that the same string is not rasterised again.
+
+//!Texts are identified by font alias, font size, text, colour and line
+//!height ratio, and rendered with the fonts of a ttf_manager. Rendered
+//!texts are kept under a budget of bytes (four per pixel), evicting the
+//!least recently used first. Texts are handed out as shared pointers, so
+//!an evicted text lives on while something still holds it (outside of the
+//!budget). A cached text is shared by everyone asking for it, so it must
+//!be moved into place before each draw. Each text holds a font_ref, so its
+//!font is not closed to fit the budget of the manager while the text lives.
+class ttf_text_cache {
+
+	public:
+
+	//!Renders with the fonts of the given manager, which must outlive the
+	//!cache, keeping up to the given bytes.
+	                            ttf_text_cache(const ttf_manager&, std::size_t=16 * 1024 * 1024);
+
+	//!Returns the given text rendered with the given font alias, size,
+	//!colour and line height ratio, rendering it if it is not cached. Will
+	//!throw std::runtime_error if the font is not in the manager.
+	std::shared_ptr<ldv::ttf_representation>    get(const std::string&, int, const std::string&, const ldv::rgba_color&, double=1.);
+
+	//!Sets the budget in bytes, evicting as needed.
+	void                        set_budget(std::size_t);
+	std::size_t                 get_budget() const {return budget;}
+
+	//!Returns the bytes of all cached texts.
+	std::size_t                 get_bytes() const {return bytes;}
+
+	//!Returns the number of cached texts.
+	std::size_t                 size() const {return entries.size();}
+
+	const ttf_text_cache_stats& get_stats() const {return stats;}
+	void                        reset_stats() {stats=ttf_text_cache_stats{};}
+
+	//!Drops all texts.
+	void                        clear();
+
+	private:
+
+	struct key {
+
+		std::string             alias;
+		int                     size;
+		std::string             text;
+		float                   r, g, b, a;
+		double                  ratio;
+
+		bool                    operator==(const key&) const;
+	};
+
+	struct key_hash {
+
+		std::size_t             operator()(const key&) const;
+	};
+
+	//!A rendered text and the reference that keeps its font open.
+	struct held_text {
+
+		                        held_text(ttf_manager::font_ref, const ldv::rgba_color&, const std::string&, double);
+
+		ttf_manager::font_ref   font;
+		ldv::ttf_representation text;
+	};
+
+	struct entry {
+
+		key                                         id;
+		std::shared_ptr<ldv::ttf_representation>    text;
+		std::size_t                                 bytes;
+	};
+
+	//!Evicts the least recently used texts until under budget.
+	void                        trim();
+
+	const ttf_manager&          fonts;
+	std::size_t                 budget,
+	                            bytes{0};
+	std::list<entry>            entries;    //!< Most recently used first.
+	std::unordered_map<key, std::list<entry>::iterator, key_hash>   index;
+	ttf_text_cache_stats        stats;
+};
+
+}
@@ -11,9 +11,15 @@
 //External deps.
 #include <rapidjson/document.h>
 
+#include "view_token.h"
+#include "compiled_view_layout.h"
+#include "ttf_manager.h"
+
 #include <memory>
 #include <map>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace ldtools {
 
@@ -99,6 +105,16 @@ polygon:
 	points:[[0,0], [10,10], [20,10]]	(points)
 	rgba:[255,255,255,255]			(color)
 	fill: "fill"|"line"				(type of fill)
+
+Files with many layouts need not be read whole to mount one of them:
+parse_file, parse_buffer and parse_insitu take the layout name and stream
+the json instead, skipping the rest.
+
+Layout files can also be compiled ahead of time with compile_view_layout or
+the view_layout_compiler utility. The compiled file is mapped into memory by
+compiled_view_layout, with type tags resolved and every string stored once,
+and given to "parse" with the layout name. Resources are still mapped by
+handle before parsing, as with json files.
 */
 
 class view_composer {
@@ -109,6 +125,34 @@ class view_composer {
 					view_composer();
 	void			parse(const rapidjson::Value&);
 /**
+*mounts the named layout of a compiled layout file. Will throw if there is
+*no such layout or if its tokens refer to resources that are not mapped.
+*/
+	void			parse(const compiled_view_layout&, const std::string&);
+/**
+*mounts the named layout of a json layout file, read in small chunks. Layouts
+*before it are skipped without building anything, each token is built as soon
+*as it is read and the file is not read past the layout, so neither the file
+*nor a document for it are ever held in memory. Will throw if the layout is
+*not found or the file is malformed.
+*/
+	void			parse_file(const std::string&, const std::string&);
+/**
+*same as parse_file, reading the json from the given buffer and size.
+*/
+	void			parse_buffer(const char *, std::size_t, const std::string&);
+/**
+*same as parse_file, reading the json from the given null terminated buffer
+*in situ: strings are decoded in the buffer itself, which is modified, and
+*not copied.
+*/
+	void			parse_insitu(char *, const std::string&);
+/**
+*reads a json layout entry into the token, checking its attributes. Strings
+*in the token point into the json value. Will throw if the entry is malformed.
+*/
+	static void		read_token(const rapidjson::Value&, view_token&);
+/**
 *draws the layout upon the screen at its coordinates.
 */
 	void			draw(ldv::screen&);
@@ -134,16 +178,24 @@ class view_composer {
 	void			map_surface(const std::string&, const ldv::surface&);
 	void			map_font(const std::string&, const ldv::ttf_font *);
 	void			map_font(const std::string&, const ldv::ttf_font&);
+/**
+*maps a font of a ttf_manager, keeping the reference so the font is not
+*closed to fit the manager budget while the composer lives.
+*/
+	void			map_font(const std::string&, ttf_manager::font_ref);
 	void			clear_view();
 	void			clear_definitions();
 	std::size_t     size() const {return data.size();}
 /**
  * sets the text for the ttf representation identified by the first parameter.
- * If no representation is found we will just throw.
+ * If no representation is found we will just throw. Setting the text the
+ * representation already has, whoever set it, does nothing, so it is not
+ * rendered again.
  */
 	void            set_text(const std::string&, const std::string&);
 /**
- * sets the color for the text representation. 
+ * sets the color for the text representation. Setting the color it
+ * already has does nothing, so the text is not rendered again.
  */
 	void            set_text_color(const std::string&, const ldv::rgba_color&);
 /**
@@ -214,8 +266,6 @@ class view_composer {
 	static const char *		external_reference_key;
 	static const char *		rotation_key;
 
-	struct position{int x, y;};
-
 	//!Represents a singular drawable.
 
 	struct item {
@@ -245,23 +295,26 @@ class view_composer {
 	};
 
 
-	uptr_rep		create_box(const rapidjson::Value&);
-	uptr_rep		create_bitmap(const rapidjson::Value&);
-	uptr_rep		create_ttf(const rapidjson::Value&);
-	uptr_rep		create_polygon(const rapidjson::Value&);
-	void			do_screen(const rapidjson::Value&);
-	void			do_definition(const rapidjson::Value&);
-
-	ldv::rect		box_from_list(const rapidjson::Value&);
-	ldv::rgba_color		rgba_from_list(const rapidjson::Value&);
-	position		position_from_list(const rapidjson::Value&);
+	//!Mounts the named layout from a json stream with the given rapidjson parse flags.
+	template<unsigned F, typename S>
+	void			parse_stream(S&, const std::string&);
+	//!Adds the representation or definition of the token.
+	void			build(const view_token&);
+	uptr_rep		create_box(const view_token&);
+	uptr_rep		create_bitmap(const view_token&);
+	uptr_rep		create_ttf(const view_token&);
+	uptr_rep		create_polygon(const view_token&);
+	void			do_screen(const view_token&);
+	void			do_definition(const view_token&);
 
+	//Handle maps are searched with the views in tokens, without building strings.
 	std::vector<item>				data;
-	std::map<std::string, ldv::representation*>	id_map;
-	std::map<std::string, ldv::representation*>	external_map;
-	std::map<std::string, const ldv::texture*>		texture_map;
-	std::map<std::string, const ldv::surface*>		surface_map;
-	std::map<std::string, const ldv::ttf_font*>	font_map;
+	std::map<std::string, ldv::representation*, std::less<>>	id_map;
+	std::map<std::string, ldv::representation*, std::less<>>	external_map;
+	std::map<std::string, const ldv::texture*, std::less<>>		texture_map;
+	std::map<std::string, const ldv::surface*, std::less<>>		surface_map;
+	std::map<std::string, const ldv::ttf_font*, std::less<>>	font_map;
+	std::vector<ttf_manager::font_ref>		font_refs;	//!< Keep the managed fonts in font_map open.
 	std::map<std::string, int>			int_definitions;
 	std::map<std::string, float>			float_definitions;
 
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "compiled_view_layout.h"
+
+#include <rapidjson/document.h>
+
+#include <string>
+
+namespace ldtools {
+
+//!Writes every layout of the json object (each member whose value is an
+//!array, as view_composer::parse takes them) in the compiled format to the
+//!given path. Will throw std::runtime_error if a token is malformed or the
+//!file cannot be written.
+
+//!Tokens are checked as view_composer would, but resources (textures, fonts,
+//!externals) are only resolved by name when the compiled layout is parsed.
+void compile_view_layout(const rapidjson::Value&, const std::string&);
+
+//!Converts the json layout file in the first path to a compiled file in the
+//!second one. Will throw std::runtime_error on failure.
+void compile_view_layout(const std::string&, const std::string&);
+
+}
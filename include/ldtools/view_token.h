@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ldtools {
+
+//!One entry of a view layout, however it was read.
+
+//!view_composer builds its representations and definitions from these, so
+//!the json and compiled layouts share the same code. Strings are views into
+//!the source they were read from and must outlive the token. Only the fields
+//!of the type of the token are meaningful, optional ones are told apart by
+//!their flags.
+
+struct view_token {
+
+	//!Type of the entry.
+	enum class types : std::uint8_t {
+		box, bitmap, ttf, polygon, external, screen, definition
+	};
+
+	//!Flags for optional attributes.
+	enum flags : std::uint32_t {
+		has_order=1,        //!< order was given.
+		has_alpha=2,        //!< alpha was given.
+		has_rotation=4,     //!< rotate was given.
+		has_visible=8,      //!< visible was given, its value is the next flag.
+		visible=16,         //!< Value of visible.
+		has_brush=32,       //!< A bitmap brush was given.
+		has_ratio=64,       //!< A ttf line height ratio was given.
+		line_fill=128,      //!< Polygon filled with lines.
+		has_id=256,         //!< id was given.
+		integer=512         //!< The definition is an integer (float otherwise).
+	};
+
+	//!Point of a polygon.
+	struct point {int x, y;};
+
+	//!Resets every field for reuse, keeping the point storage, so that
+	//!nothing of a previous entry leaks into the fields another type leaves
+	//!alone.
+	void                    clear() {
+
+		auto storage=std::move(points);
+		storage.clear();
+		*this=view_token{};
+		points=std::move(storage);
+	}
+
+	//!Returns true if the flag is set.
+	bool                    has(flags _flag) const {return flag_set & _flag;}
+
+	//!Sets the flag.
+	void                    set(flags _flag) {flag_set|=_flag;}
+
+	types                   type{types::box};   //!< Type of the entry.
+	std::uint32_t           flag_set{0};        //!< Combination of flags.
+	int                     order{0},           //!< Draw order.
+	                        alpha{0},           //!< Alpha value.
+	                        rotation[3]{},      //!< Degrees and rotation center.
+	                        location[4]{},      //!< Position (x, y, and w, h for boxes and bitmaps).
+	                        clip[4]{},          //!< Bitmap texture clip.
+	                        brush[2]{},         //!< Bitmap brush size.
+	                        rgba[4]{},          //!< Colour.
+	                        int_value{0};       //!< Integer definition value.
+	float                   float_value{0.f};   //!< Float definition value.
+	double                  ratio{1.};          //!< ttf line height ratio.
+	std::string_view        id,                 //!< Representation id.
+	                        resource,           //!< Font, texture, external reference or definition key.
+	                        text;               //!< ttf text.
+	std::vector<point>      points;             //!< Polygon points.
+};
+
+}
@@ -0,0 +1,431 @@
+#include <ldtools/animation_batch.h>
+#include <ldtools/profiler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+using namespace ldtools;
+
+//!Persistent helper threads. Each run hands them the same task with their
+//!own index (the calling thread takes index 0) and waits for all of them.
+
+class animation_batch::worker_pool {
+
+	public:
+
+	//!Will start the given number of helper threads on the first run.
+	explicit                worker_pool(std::size_t _helpers)
+		:helpers(_helpers) {}
+
+	                        ~worker_pool() {stop();}
+
+	//!Calls the task with the indexes from 0 to the given count minus one,
+	//!each in its own thread, and waits for all of them. Will throw if the
+	//!threads cannot be started, or what the task threw (in this thread
+	//!first, then the first helper that failed).
+	void                    run(std::size_t, const std::function<void(std::size_t)>&);
+
+	private:
+
+	//!Starts the helper threads. Joins the ones started if one fails.
+	void                    start();
+
+	//!Stops and joins the helper threads.
+	void                    stop();
+
+	//!Helper thread loop. Runs the generations after the given one.
+	void                    work(std::size_t, std::uint64_t);
+
+	std::size_t                                 helpers;
+	std::vector<std::thread>                    threads;
+	std::mutex                                  run_mutex,  //!< One run at a time.
+	                                            mutex;      //!< Guards the state below.
+	std::condition_variable                     wake,       //!< A run or stop is due.
+	                                            done;       //!< The helpers finished.
+	const std::function<void(std::size_t)> *    task{nullptr};
+	std::size_t                                 count{0},
+	                                            remaining{0};
+	std::uint64_t                               generation{0};
+	std::exception_ptr                          helper_error;   //!< First error of a helper in this run.
+	bool                                        stopping{false};
+};
+
+void animation_batch::worker_pool::run(
+	std::size_t _count,
+	const std::function<void(std::size_t)>& _task
+) {
+
+	std::lock_guard<std::mutex> run_lock(run_mutex);
+
+	if(threads.empty()) {
+
+		start();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		task=&_task;
+		count=_count;
+		remaining=threads.size();
+		++generation;
+	}
+
+	wake.notify_all();
+
+	//The helpers must be done with the task before this returns, whatever
+	//happens here.
+	std::exception_ptr error;
+	try {
+		_task(0);
+	}
+	catch(...) {
+		error=std::current_exception();
+	}
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [this]() {return !remaining;});
+	task=nullptr;
+
+	if(!error) {
+
+		error=helper_error;
+	}
+
+	helper_error=nullptr;
+
+	if(error) {
+
+		std::rethrow_exception(error);
+	}
+}
+
+void animation_batch::worker_pool::start() {
+
+	threads.reserve(helpers);
+
+	//Helpers start waiting for the run after the current one, however late
+	//they get to look at the generation. Runs are serialized, so it cannot
+	//change while they start.
+	const std::uint64_t current=generation;
+
+	try {
+		for(std::size_t i=0; i<helpers; i++) {
+
+			threads.emplace_back(&worker_pool::work, this, i+1, current);
+		}
+	}
+	catch(...) {
+
+		stop();
+		throw;
+	}
+}
+
+void animation_batch::worker_pool::stop() {
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping=true;
+	}
+
+	wake.notify_all();
+
+	for(auto& t : threads) {
+
+		t.join();
+	}
+
+	threads.clear();
+	stopping=false;
+}
+
+void animation_batch::worker_pool::work(
+	std::size_t _index,
+	std::uint64_t _seen
+) {
+
+	LDTOOLS_PROFILE_THREAD("animation_batch worker");
+
+	std::unique_lock<std::mutex> lock(mutex);
+	std::uint64_t seen=_seen;
+
+	while(true) {
+
+		wake.wait(lock, [this, &seen]() {return stopping || generation!=seen;});
+
+		if(stopping) {
+
+			return;
+		}
+
+		seen=generation;
+		if(_index < count) {
+
+			const auto * current=task;
+			lock.unlock();
+
+			//The run must reach its end, so errors are kept for run to
+			//throw.
+			std::exception_ptr error;
+			try {
+				(*current)(_index);
+			}
+			catch(...) {
+				error=std::current_exception();
+			}
+
+			lock.lock();
+
+			if(error && !helper_error) {
+
+				helper_error=error;
+			}
+		}
+
+		if(!--remaining) {
+
+			done.notify_one();
+		}
+	}
+}
+
+animation_batch::animation_batch(
+	const animation_table& _table,
+	std::size_t _threads
+)
+	:table(_table), threads(_threads) {
+
+	if(!threads) {
+
+		threads=std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	if(threads > 1) {
+
+		helpers=std::make_unique<worker_pool>(threads-1);
+	}
+
+	rebuild();
+}
+
+animation_batch::~animation_batch() {
+
+}
+
+void animation_batch::rebuild() {
+
+	ends.clear();
+	offsets.clear();
+	counts.clear();
+	durations.clear();
+	sorted.clear();
+	sources.clear();
+	ids.clear();
+	direct.clear();
+	steps=0;
+
+	std::uint32_t longest=0;
+	for(const auto& pair : table.data) {
+
+		const auto& anim=pair.second;
+		ids.push_back(pair.first);
+		offsets.push_back(ends.size());
+		counts.push_back(anim.ends.size());
+		durations.push_back(anim.duration);
+		sorted.push_back(anim.sorted && anim.ends.size()==anim.data.size());
+		sources.push_back(&anim);
+		ends.insert(std::end(ends), std::begin(anim.ends), std::end(anim.ends));
+		longest=std::max(longest, counts.back());
+	}
+
+	//Lets the search read past empty animations at the end of the pool.
+	ends.push_back(0.f);
+
+	for(std::uint32_t n=longest; n > 1; n-=n / 2) {
+
+		++steps;
+	}
+
+	//Animation ids are usually small, so they can index a vector.
+	if(ids.size() && ids.back() < 4 * ids.size() + 1024) {
+
+		direct.assign(ids.back()+1, none);
+		for(std::size_t i=0; i<ids.size(); i++) {
+
+			direct[ids[i]]=i;
+		}
+	}
+}
+
+void animation_batch::index_for_time(
+	const std::size_t * _ids,
+	const float * _times,
+	const float * _durations,
+	std::size_t _count,
+	std::size_t * _out
+) const {
+
+	LDTOOLS_PROFILE_ZONE("animation_batch::index_for_time");
+	run(_ids, _times, _durations, _count, [_out](std::size_t _i, const animation *, std::size_t _index) {
+
+		_out[_i]=_index;
+	});
+}
+
+void animation_batch::frames_for_time(
+	const std::size_t * _ids,
+	const float * _times,
+	const float * _durations,
+	std::size_t _count,
+	const sprite_frame ** _out
+) const {
+
+	LDTOOLS_PROFILE_ZONE("animation_batch::frames_for_time");
+	run(_ids, _times, _durations, _count, [_out](std::size_t _i, const animation * _anim, std::size_t _index) {
+
+		_out[_i]=&_anim->get(_index).frame;
+	});
+}
+
+std::uint32_t animation_batch::slot_for(
+	std::size_t _id
+) const {
+
+	if(direct.size()) {
+
+		return _id < direct.size() ? direct[_id] : none;
+	}
+
+	const auto it=std::lower_bound(std::begin(ids), std::end(ids), _id);
+	return it==std::end(ids) || *it!=_id ? none : it-std::begin(ids);
+}
+
+template<typename O>
+void animation_batch::run(
+	const std::size_t * _ids,
+	const float * _times,
+	const float * _durations,
+	std::size_t _count,
+	O _out
+) const {
+
+	//Threads are not worth it for small batches.
+	const std::size_t min_per_thread=4096,
+		workers=std::min(threads, (_count+min_per_thread-1) / min_per_thread);
+
+	if(workers <= 1) {
+
+		evaluate(_ids, _times, _durations, 0, _count, _out);
+		return;
+	}
+
+	const std::size_t chunk=(_count+workers-1) / workers;
+
+	helpers->run(workers, [&](std::size_t _w) {
+
+		evaluate(_ids, _times, _durations, _w * chunk, std::min(_count, (_w+1) * chunk), _out);
+	});
+}
+
+template<typename O>
+void animation_batch::evaluate(
+	const std::size_t * _ids,
+	const float * _times,
+	const float * _durations,
+	std::size_t _begin,
+	std::size_t _end,
+	O _out
+) const {
+
+	LDTOOLS_PROFILE_ZONE("animation_batch::evaluate");
+
+	constexpr std::size_t block=256;
+	std::uint32_t slots[block], base[block], n[block];
+	float t[block], mult[block], own[block];
+	unsigned char slow[block];
+
+	const float * pool=ends.data();
+	const float largest=std::numeric_limits<float>::max();
+
+	for(std::size_t first=_begin; first < _end; first+=block) {
+
+		const std::size_t len=std::min(block, _end-first);
+
+		//Gather the animation of each entity.
+		for(std::size_t i=0; i<len; i++) {
+
+			const auto slot=slot_for(_ids[first+i]);
+			if(none==slot) {
+
+				throw animation_batch_exception("no animation with id "+std::to_string(_ids[first+i]));
+			}
+
+			slots[i]=slot;
+			base[i]=offsets[slot];
+			n[i]=counts[slot];
+			own[i]=durations[slot];
+			mult[i]=_durations ? _durations[first+i] : own[i];
+			slow[i]=!sorted[slot] | (n[i] < 2);
+		}
+
+		//Wrap the times as fmod does. The quotient is exact enough in double
+		//precision to truncate it when it is below 2^28, and then the
+		//remainder is exact too. Anything else takes the slow path.
+		for(std::size_t i=0; i<len; i++) {
+
+			const double total=mult[i],
+				time=_times[first+i],
+				q=time / total;
+
+			const bool fits=std::fabs(q) < 268435456.;
+			const int whole=(int)(fits ? q : 0.);
+			t[i]=(float)(time - (double)whole * total);
+
+			const float m=mult[i] / own[i];
+			mult[i]=m;
+			slow[i]|=!fits | !(m > 0.f) | !(m <= largest);
+		}
+
+		//Search all entities one step at a time, same comparison as
+		//animation::index_for_time.
+		for(unsigned s=0; s<steps; s++) {
+
+			for(std::size_t i=0; i<len; i++) {
+
+				const std::uint32_t half=n[i] / 2;
+				base[i]+=pool[base[i]+half] * mult[i] < t[i] ? half : 0;
+				n[i]-=half;
+			}
+		}
+
+		for(std::size_t i=0; i<len; i++) {
+
+			const auto slot=slots[i];
+			const auto * anim=sources[slot];
+			std::size_t index=0;
+
+			if(slow[i]) {
+
+				index=_durations
+					? anim->index_for_time(_times[first+i], _durations[first+i])
+					: anim->index_for_time(_times[first+i]);
+			}
+			else {
+
+				index=base[i]-offsets[slot]+(pool[base[i]] * mult[i] < t[i]);
+				if(index==counts[slot]) {
+
+					index=0;
+				}
+			}
+
+			_out(first+i, anim, index);
+		}
+	}
+}
@@ -0,0 +1,85 @@
+#include <ldtools/animation_event_bus.h>
+#include <ldtools/profiler.h>
+
+using namespace ldtools;
+
+void animation_event_bus::subscribe(
+	std::uint32_t _event,
+	animation_event_delegate _delegate
+) {
+
+	if(_event >= by_event.size()) {
+
+		by_event.resize(_event+1);
+	}
+
+	by_event[_event].push_back(_delegate);
+}
+
+void animation_event_bus::subscribe(
+	animation_event_delegate _delegate
+) {
+
+	to_all.push_back(_delegate);
+}
+
+void animation_event_bus::clear_subscriptions() {
+
+	by_event.clear();
+	to_all.clear();
+}
+
+std::size_t animation_event_bus::advance(
+	animation_player * _players,
+	const float * _deltas,
+	std::size_t _count,
+	std::size_t _first_entity
+) {
+
+	LDTOOLS_PROFILE_ZONE("animation_event_bus::advance");
+
+	const std::size_t before=queue.size();
+	for(std::size_t i=0; i<_count; i++) {
+
+		auto& player=_players[i];
+		const std::size_t entity=_first_entity+i;
+
+		player.advance(_deltas[i], [this, &player, entity](std::size_t _frame) {
+
+			const auto range=player.get_events(_frame);
+			for(const auto * it=range.first; it!=range.second; ++it) {
+
+				queue.push_back({entity, _frame, *it});
+			}
+		});
+	}
+
+	return queue.size()-before;
+}
+
+std::size_t animation_event_bus::dispatch() {
+
+	LDTOOLS_PROFILE_ZONE("animation_event_bus::dispatch");
+
+	//Delegates may queue more events: those wait for the next dispatch.
+	const std::size_t count=queue.size();
+	for(std::size_t i=0; i<count; i++) {
+
+		const animation_event event=queue[i];
+		if(event.event < by_event.size()) {
+
+			for(const auto& delegate : by_event[event.event]) {
+
+				delegate(event);
+			}
+		}
+
+		for(const auto& delegate : to_all) {
+
+			delegate(event);
+		}
+	}
+
+	queue.erase(std::begin(queue), std::begin(queue)+count);
+	return count;
+}
@@ -0,0 +1,91 @@
+#include <ldtools/animation_player.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace ldtools;
+
+animation_player::animation_player(
+	const animation& _animation,
+	modes _mode
+)
+	:source(&_animation),
+	revision(_animation.revision),
+	lines(_animation.data.data()),
+	ends(_animation.ends.data()),
+	events(_animation.events.data()),
+	count(_animation.data.size()),
+	duration(_animation.duration),
+	mode(_mode) {
+
+	check(_animation.sorted);
+}
+
+animation_player::animation_player(
+	const animation_handle& _animation,
+	modes _mode
+)
+	:lines(_animation.lines),
+	ends(_animation.ends),
+	events(_animation.events),
+	count(_animation.count),
+	duration(_animation.duration),
+	mode(_mode) {
+
+	check(_animation.sorted);
+}
+
+void animation_player::reset() {
+
+	if(source && source->revision!=revision) {
+
+		rebind();
+	}
+
+	position=0.f;
+	cursor=0;
+	forward=true;
+	finished=false;
+	started=false;
+}
+
+void animation_player::check(
+	bool _sorted
+) const {
+
+	if(!_sorted) {
+
+		throw std::runtime_error("cannot play an animation with negative frame durations");
+	}
+
+	if(!count) {
+
+		throw std::runtime_error("cannot play an animation without frames");
+	}
+
+	if(!(duration > 0.f)) {
+
+		throw std::runtime_error("cannot play an animation without duration");
+	}
+}
+
+void animation_player::rebind() {
+
+	lines=source->data.data();
+	ends=source->ends.data();
+	events=source->events.data();
+	count=source->data.size();
+	duration=source->duration;
+	revision=source->revision;
+	check(source->sorted);
+
+	//Loops never rest at their end, the other modes may.
+	position=std::min(position, duration);
+	if(modes::loop==mode && position >= duration) {
+
+		position=0.f;
+	}
+
+	finished=modes::once==mode && position >= duration;
+	cursor=std::min<std::size_t>(std::lower_bound(ends, ends+count, position)-ends, count-1);
+}
@@ -0,0 +1,169 @@
+#include <ldtools/animation_store.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace ldtools;
+
+animation_handle::animation_handle(
+	const animation_line * _lines,
+	const float * _ends,
+	const std::uint32_t * _events,
+	const std::string * _name,
+	std::uint32_t _count,
+	float _duration,
+	bool _sorted
+)
+	:lines(_lines), ends(_ends), events(_events), name(_name), count(_count), duration(_duration), sorted(_sorted) {
+
+}
+
+const animation_line& animation_handle::get(
+	std::size_t _index
+) const {
+
+	if(_index >= count) {
+
+		throw std::out_of_range("invalid animation frame "+std::to_string(_index));
+	}
+
+	return lines[_index];
+}
+
+std::pair<const std::uint32_t *, const std::uint32_t *> animation_handle::get_events(
+	std::size_t _index
+) const {
+
+	const auto& line=get(_index);
+	return {events+line.first_event, events+line.first_event+line.event_count};
+}
+
+const animation_line& animation_handle::get_for_time(
+	float _t
+) const {
+
+	return get_for_time(_t, duration);
+}
+
+const animation_line& animation_handle::get_for_time(
+	float _t,
+	float _total
+) const {
+
+	return get(index_for_time(_t, _total));
+}
+
+std::size_t animation_handle::index_for_time(
+	float _t
+) const {
+
+	return index_for_time(_t, duration);
+}
+
+std::size_t animation_handle::index_for_time(
+	float _t,
+	float _total
+) const {
+
+	if(count==1) return 0;
+
+	return animation::search(ends, count, duration, sorted, _t, _total);
+}
+
+animation_store::animation_store() {
+
+}
+
+animation_store::animation_store(
+	const animation_table& _table
+) {
+
+	build(_table);
+}
+
+void animation_store::build(
+	const animation_table& _table
+) {
+
+	lines.clear();
+	ends.clear();
+	events.clear();
+	records.clear();
+	names.clear();
+	ids.clear();
+	direct.clear();
+
+	std::size_t total=0;
+	for(const auto& pair : _table.data) {
+
+		total+=pair.second.data.size();
+	}
+
+	lines.reserve(total);
+	ends.reserve(total);
+	records.reserve(_table.data.size());
+	names.reserve(_table.data.size());
+	ids.reserve(_table.data.size());
+
+	for(const auto& pair : _table.data) {
+
+		const auto& anim=pair.second;
+		records.push_back({(std::uint32_t)lines.size(), (std::uint32_t)anim.data.size(), anim.duration, anim.sorted});
+		names.push_back(anim.name);
+		ids.push_back(pair.first);
+		lines.insert(std::end(lines), std::begin(anim.data), std::end(anim.data));
+		ends.insert(std::end(ends), std::begin(anim.ends), std::end(anim.ends));
+
+		//Lines refer to the events of their animation, now in a larger pool.
+		for(auto it=std::end(lines)-anim.data.size(); it!=std::end(lines); ++it) {
+
+			it->first_event+=events.size();
+		}
+
+		events.insert(std::end(events), std::begin(anim.events), std::end(anim.events));
+	}
+
+	//Animation ids are usually small, so they can index a vector.
+	if(ids.size() && ids.back() < 4 * ids.size() + 1024) {
+
+		direct.assign(ids.back()+1, none);
+		for(std::size_t i=0; i<ids.size(); i++) {
+
+			direct[ids[i]]=i;
+		}
+	}
+}
+
+animation_handle animation_store::get(
+	std::size_t _id
+) const {
+
+	const auto pos=position(_id);
+	if(none==pos) {
+
+		throw std::out_of_range("invalid animation id "+std::to_string(_id));
+	}
+
+	const auto& r=records[pos];
+	return {lines.data()+r.offset, ends.data()+r.offset, events.data(), &names[pos], r.length, r.duration, r.sorted};
+}
+
+bool animation_store::exists(
+	std::size_t _id
+) const {
+
+	return none!=position(_id);
+}
+
+std::uint32_t animation_store::position(
+	std::size_t _id
+) const {
+
+	if(direct.size()) {
+
+		return _id < direct.size() ? direct[_id] : none;
+	}
+
+	const auto it=std::lower_bound(std::begin(ids), std::end(ids), _id);
+	return it==std::end(ids) || *it!=_id ? none : it-std::begin(ids);
+}
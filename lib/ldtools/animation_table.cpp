@@ -1,9 +1,18 @@
 #include <ldtools/animation_table.h> 
 
+#include <ldtools/mapped_file.h>
+#include <ldtools/profiler.h>
+
 //Tools deps.
-#include <tools/string_utils.h>
 #include <tools/compatibility_patches.h>
 
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
 using namespace ldtools;
 
 animation::animation()
@@ -31,12 +40,54 @@ int animation_line::get_rotation() const {
 void animation::adjust_frame_time() {
 
 	duration=0;
+	sorted=true;
+	ends.clear();
 	for(auto& l: data) {
 		duration+=l.duration;
 		l.begin_time=duration;
+		ends.push_back(duration);
+		sorted=sorted && l.duration >= 0.f;
 	}
 }
 
+std::size_t animation::search(
+	const float * _ends,
+	std::size_t _count,
+	float _duration,
+	bool _sorted,
+	float _t,
+	float _total
+) {
+
+	const float mult=_total / _duration,
+		t=fmod(_t, _total);
+
+	//Scaling by a positive finite factor keeps the order, so the frames
+	//that end before t are all at the front. The search halves the range
+	//without branching on the comparison, which is not predictable.
+	if(_sorted && std::isfinite(mult) && mult > 0.f && _count) {
+
+		const float * base=_ends;
+		for(std::size_t n=_count; n > 1;) {
+
+			const std::size_t half=n / 2;
+			base=base[half] * mult < t ? base+half : base;
+			n-=half;
+		}
+
+		const std::size_t index=(base-_ends)+(*base * mult < t);
+		return index==_count ? 0 : index;
+	}
+
+	for(std::size_t res=0; res<_count; res++) {
+		if(t <= _ends[res] * mult) {
+			return res;
+		}
+	}
+
+	return 0;
+}
+
 const animation_line& animation::get_for_time(float t) const {
 
 	return get_for_time(t, duration);
@@ -47,15 +98,7 @@ const animation_line& animation::get_for_time(float t, float total) const {
 
 	if(data.size()==1) return data.at(0);
 
-	float mult=total / duration;
-	float transformado=fmod(t, total);
-	for(const animation_line& fr : data) {
-		if(transformado <= fr.begin_time * mult) {
-			return fr;
-		}
-	}
-
-	return data.at(0);
+	return data.at(search(ends.data(), ends.size(), duration, sorted, t, total));
 }
 
 std::size_t animation::index_for_time(
@@ -72,17 +115,54 @@ std::size_t animation::index_for_time(
 
 	if(data.size()==1) return 0;
 
-	std::size_t res{0};
-	float mult=_duration / duration;
-	float transformado=fmod(_t, _duration);
-	for(const animation_line& fr : data) {
-		if(transformado <= fr.begin_time * mult) {
-			return res;
-		}
-		++res;
+	return search(ends.data(), ends.size(), duration, sorted, _t, _duration);
+}
+
+std::pair<const std::uint32_t *, const std::uint32_t *> animation::get_events(
+	size_t _index
+) const {
+
+	const auto& line=data.at(_index);
+	const std::uint32_t * first=events.data()+line.first_event;
+	return {first, first+line.event_count};
+}
+
+animation_tick_table::animation_tick_table(
+	const animation& _animation,
+	float _tick
+)
+	:animation_tick_table(_animation, _tick, _animation.get_duration()) {
+
+}
+
+animation_tick_table::animation_tick_table(
+	const animation& _animation,
+	float _tick,
+	float _duration
+)
+	:source(&_animation), tick(_tick) {
+
+	if(!_animation.size()) {
+
+		throw std::runtime_error("cannot bake an empty animation");
 	}
 
-	return 0;
+	if(!(_tick > 0.f) || !(_duration > 0.f)) {
+
+		throw std::runtime_error("cannot bake an animation without positive tick and duration");
+	}
+
+	const float ticks=std::round(_duration / _tick);
+	if(ticks < 1.f || std::fabs(ticks * _tick - _duration) > _tick / 100.f) {
+
+		throw std::runtime_error("animation duration is not a whole number of ticks");
+	}
+
+	indexes.resize((std::size_t)ticks);
+	for(std::size_t i=0; i<indexes.size(); i++) {
+
+		indexes[i]=_animation.index_for_time((float)i * _tick, _duration);
+	}
 }
 
 animation_table::animation_table(const sprite_table& t)
@@ -96,99 +176,352 @@ animation_table::animation_table(const sprite_table& t, const std::string& ruta)
 
 void animation_table::load(const std::string& ruta) {
 
-	tools::text_reader L(ruta, '#');
+	LDTOOLS_PROFILE_ZONE("animation_table::load");
 
-	if(!L) {
+	std::unique_ptr<mapped_file> file;
+	try {
+		file=std::make_unique<mapped_file>(ruta);
+	}
+	catch(mapped_file_exception&) {
 		throw std::runtime_error(std::string("Unable to locate animation file ")+ruta);
 	}
-	else {
-		std::string linea;
-		const char inicio_titulo='*';
-		const char inicio_cabecera='!';
-		size_t id=0;
-		animation animacion;
 
-		auto insertar_anim=[this](animation panimacion, size_t pid) {
-			panimacion.adjust_frame_time();
-			data[pid]=panimacion;
-		};
+	const char inicio_titulo='*';
+	const char inicio_cabecera='!';
+	const char inicio_evento='@';
+	const char comentario='#';
+
+	//Everything goes to a new map, so a failed load changes nothing.
+	std::map<size_t, animation> fresh;
+	size_t id=0, line_number=0;
+	animation animacion;
+
+	auto insertar_anim=[&fresh](animation& panimacion, size_t pid) {
+		panimacion.adjust_frame_time();
+		fresh[pid]=std::move(panimacion);
+	};
+
+	const char * cursor=file->data(),
+		* const file_end=cursor+file->size();
+
+	while(cursor!=file_end) {
+
+		const char * line=cursor,
+			* line_end=static_cast<const char *>(std::memchr(cursor, '\n', file_end-cursor));
+
+		if(!line_end) {
+			line_end=file_end;
+			cursor=file_end;
+		}
+		else {
+			cursor=line_end+1;
+		}
+
+		++line_number;
+		if(line==line_end || comentario==*line) {
+			continue;
+		}
 
 		try {
-			while(true) {
-				linea=L.read_line();
-				if(L.is_eof()) {
-					//Insertar la última animación...
-					if(animacion) {
-						insertar_anim(animacion, id);
+			switch(*line) {
+				case inicio_titulo:
+					if(animacion) insertar_anim(animacion, id);
+					animacion=animation(); //Reset animación...
+					animacion.name.assign(line+1, line_end);
+				break;
+				case inicio_cabecera:
+					if(!parse_header(line+1, line_end, id)) {
+						throw std::runtime_error("Error reading animation header.");
 					}
-					break;
+				break;
+				case inicio_evento: {
+					const char * name_begin=line+1,
+						* name_end=line_end;
+
+					while(name_end!=name_begin && std::isspace((unsigned char)name_end[-1])) {
+						--name_end;
+					}
+
+					if(name_begin==name_end) {
+						throw std::runtime_error("Error reading animation event: no name.");
+					}
+
+					if(!animacion.data.size()) {
+						throw std::runtime_error("Error reading animation event: no frame before it.");
+					}
+
+					//Events of a frame follow it, so they are contiguous.
+					auto& frame_line=animacion.data.back();
+					if(!frame_line.event_count) {
+						frame_line.first_event=animacion.events.size();
+					}
+
+					animacion.events.push_back(intern_event(std::string(name_begin, name_end)));
+					++frame_line.event_count;
 				}
+				break;
+				default: {
+					int duration=0, indice_frame=0, flags=0;
+					if(!parse_line(line, line_end, duration, indice_frame, flags)) {
+						throw std::runtime_error("Error reading animation line.");
+					}
 
-				const char inicio=linea[0];
-				switch(inicio) {
-					case inicio_titulo:
-						if(animacion) insertar_anim(animacion, id);
-						animacion=animation(); //Reset animación...
-						animacion.name=linea.substr(1);
-					break;
-					case inicio_cabecera:
-						id=read_header(linea.substr(1));
-					break;
-					default:
-						read_line(linea, animacion);
-					break;
+					const auto& frame=table.get(indice_frame);
+					float dur=(float)duration / 1000.f;
+					animacion.data.push_back(animation_line(dur, 0.0f, frame, flags, indice_frame));
 				}
+				break;
 			}
 		}
 		catch(std::exception& e) {
-			std::string error=e.what()+std::string(" : line ")+compat::to_string(L.get_line_number())+std::string(" ["+linea+"]. aborting.");
+			std::string error=e.what()+std::string(" : line ")+compat::to_string(line_number)+std::string(" ["+std::string(line, line_end)+"]. aborting.");
 			throw std::runtime_error(error);
 		}
 	}
+
+	//Insertar la última animación...
+	if(animacion) {
+		insertar_anim(animacion, id);
+	}
+
+	data.swap(fresh);
+}
+
+animation_table::animation_table(const sprite_table& t, const embedded_animation_table& _embedded)
+	:table(t) {
+	load(_embedded);
 }
 
-size_t animation_table::read_header(const std::string& linea) {
+void animation_table::load(
+	const embedded_animation_table& _embedded
+) {
+
+	std::map<size_t, animation> fresh;
+
+	for(std::size_t i=0; i<_embedded.animation_count; i++) {
+
+		const auto& e=_embedded.animations[i];
+		animation anim;
+		anim.name=e.name;
+		anim.data.reserve(e.line_count);
+
+		for(std::size_t l=e.first_line; l<e.first_line+e.line_count; l++) {
+
+			const auto& line=_embedded.lines[l];
+			animation_line result(line.duration, 0.0f, table.get(line.frame), line.flags, line.frame);
+
+			if(line.event_count) {
+
+				result.first_event=anim.events.size();
+				result.event_count=line.event_count;
+				for(std::size_t ev=line.first_event; ev<line.first_event+line.event_count; ev++) {
+
+					anim.events.push_back(intern_event(_embedded.events[ev]));
+				}
+			}
 
-	const char separador='\t';
-	const std::vector<std::string> valores=tools::explode(linea, separador);
-	if(valores.size()==1) {
+			anim.data.push_back(result);
+		}
 
-		int id=std::atoi(valores[0].c_str());
-		return id;
+		anim.adjust_frame_time();
+		fresh.emplace_hint(std::end(fresh), e.id, std::move(anim));
 	}
-	else {
-		throw std::runtime_error("Error reading animation header.");
+
+	data.swap(fresh);
+}
+
+std::vector<size_t> animation_table::get_ids() const {
+
+	std::vector<size_t> result;
+	result.reserve(data.size());
+	for(const auto& pair : data) {
+
+		result.push_back(pair.first);
 	}
+
+	return result;
 }
 
-void animation_table::read_line(const std::string& linea, animation& animacion) {
+std::vector<size_t> animation_table::reload(
+	const std::string& _path
+) {
 
-	const char separador='\t';
-	std::vector<std::string> valores=tools::explode(linea, separador);
-	if(valores.size()==2 || valores.size()==3) {
+	animation_table fresh{table};
+	fresh.load(_path);
 
-		int duration=std::atoi(valores[0].c_str());
-		int indice_frame=std::atoi(valores[1].c_str());
-		int flags=0;
+	//Erasing would leave references to the animation dangling.
+	for(const auto& pair : data) {
 
-		if(3 == valores.size()) {
+		if(!fresh.data.count(pair.first)) {
 
-			flags=std::stoi(valores[2]);
+			throw std::runtime_error("animation "+std::to_string(pair.first)+" is no longer in "+_path);
 		}
+	}
 
-		try {
-			const auto& frame=table.get(indice_frame);
+	//The fresh table numbers events on its own.
+	for(auto& pair : fresh.data) {
+
+		for(auto& event : pair.second.events) {
+
+			event=intern_event(fresh.event_names[event]);
+		}
+	}
+
+	auto same_line=[](const animation_line& _a, const animation_line& _b) {
+
+		return _a.duration==_b.duration
+			&& _a.frame_index==_b.frame_index
+			&& _a.flags==_b.flags
+			&& _a.frame==_b.frame
+			&& _a.first_event==_b.first_event
+			&& _a.event_count==_b.event_count;
+	};
+
+	std::vector<size_t> changed;
+	for(auto& pair : fresh.data) {
+
+		auto it=data.find(pair.first);
+		if(it!=std::end(data)
+			&& it->second.name==pair.second.name
+			&& it->second.events==pair.second.events
+			&& std::equal(std::begin(it->second.data), std::end(it->second.data), std::begin(pair.second.data), std::end(pair.second.data), same_line)
+		) {
 
-			float dur=(float)duration / 1000.f;
-			animacion.duration+=dur;
-			animacion.data.push_back(animation_line(dur, 0.0f, frame, flags));
-			animacion.adjust_frame_time();
+			continue;
 		}
-		catch(std::out_of_range& e) {
-			throw e;
+
+		//Players of the animation see the new revision and catch up.
+		if(it!=std::end(data)) {
+
+			pair.second.revision=it->second.revision+1;
 		}
+
+		changed.push_back(pair.first);
+		data[pair.first]=std::move(pair.second);
 	}
-	else {
-		throw std::runtime_error("Error reading animation line.");
+
+	std::sort(std::begin(changed), std::end(changed));
+	return changed;
+}
+
+size_t animation_table::refresh_frames(
+	const std::vector<size_t>& _indexes
+) {
+
+	//Checked first, so a missing frame leaves every line as it was.
+	check_frames(table, _indexes);
+
+	size_t result=0;
+	for(auto& pair : data) {
+
+		for(auto& line : pair.second.data) {
+
+			if(std::binary_search(std::begin(_indexes), std::end(_indexes), line.frame_index)) {
+
+				line.frame=table.get(line.frame_index);
+				++result;
+			}
+		}
 	}
+
+	return result;
+}
+
+void animation_table::check_frames(
+	const sprite_table& _table,
+	const std::vector<size_t>& _indexes
+) const {
+
+	for(const auto& pair : data) {
+
+		for(const auto& line : pair.second.data) {
+
+			if(std::binary_search(std::begin(_indexes), std::end(_indexes), line.frame_index)
+				&& !_table.exists(line.frame_index)
+			) {
+
+				throw std::runtime_error("frame "+std::to_string(line.frame_index)+" is used by animation "+std::to_string(pair.first)+" but is no longer in the sprite table");
+			}
+		}
+	}
+}
+
+std::uint32_t animation_table::intern_event(
+	const std::string& _name
+) {
+
+	const auto it=event_ids.find(_name);
+	if(it!=std::end(event_ids)) {
+
+		return it->second;
+	}
+
+	const std::uint32_t id=event_names.size();
+	event_names.push_back(_name);
+	event_ids.emplace(_name, id);
+	return id;
+}
+
+bool animation_table::parse_header(
+	const char * _cursor,
+	const char * _end,
+	size_t& _id
+) {
+
+	return read_value(_cursor, _end, _id) && at_end(_cursor, _end);
+}
+
+bool animation_table::parse_line(
+	const char * _cursor,
+	const char * _end,
+	int& _duration,
+	int& _frame,
+	int& _flags
+) {
+
+	if(!read_value(_cursor, _end, _duration) || !read_value(_cursor, _end, _frame)) {
+
+		return false;
+	}
+
+	if(at_end(_cursor, _end)) {
+
+		_flags=0;
+		return true;
+	}
+
+	return read_value(_cursor, _end, _flags) && at_end(_cursor, _end);
+}
+
+template<typename T>
+bool animation_table::read_value(
+	const char *& _cursor,
+	const char * _end,
+	T& _value
+) {
+
+	while(_cursor!=_end && std::isspace((unsigned char)*_cursor)) {
+		++_cursor;
+	}
+
+	if(_cursor!=_end && '+'==*_cursor) {
+		++_cursor;
+	}
+
+	const auto result=std::from_chars(_cursor, _end, _value);
+	if(std::errc{}!=result.ec) {
+
+		return false;
+	}
+
+	_cursor=result.ptr;
+	return true;
+}
+
+bool animation_table::at_end(
+	const char * _cursor,
+	const char * _end
+) {
+
+	return std::all_of(_cursor, _end, [](char _c) {return std::isspace((unsigned char)_c);});
 }
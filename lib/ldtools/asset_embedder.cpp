@@ -0,0 +1,193 @@
+#include <ldtools/asset_embedder.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+
+using namespace ldtools;
+
+//!Throws if the given name cannot be used as a C++ identifier.
+static void check_identifier(
+	const std::string& _name
+) {
+
+	auto valid=[](char _c) {return std::isalnum((unsigned char)_c) || '_'==_c;};
+
+	if(!_name.size() || std::isdigit((unsigned char)_name[0]) || !std::all_of(std::begin(_name), std::end(_name), valid)) {
+
+		throw std::runtime_error("'"+_name+"' cannot be used as an embedded asset name");
+	}
+}
+
+//!Writes the given text as a C++ string literal.
+static void write_literal(
+	const std::string& _text,
+	std::ostream& _out
+) {
+
+	_out<<'"';
+	for(unsigned char c : _text) {
+
+		if('"'==c || '\\'==c) {
+
+			_out<<'\\'<<c;
+		}
+		else if(std::isprint(c)) {
+
+			_out<<c;
+		}
+		else {
+
+			//Always three digits, so a following digit is not taken in.
+			_out<<'\\'<<std::oct<<std::setw(3)<<std::setfill('0')<<(unsigned)c<<std::dec<<std::setfill(' ');
+		}
+	}
+
+	_out<<'"';
+}
+
+static void write_preamble(
+	std::ostream& _out
+) {
+
+	_out<<"#pragma once\n\n"
+		<<"//Generated by asset_embedder, do not edit.\n\n"
+		<<"#include <ldtools/embedded_assets.h>\n\n";
+}
+
+void ldtools::embed_sprite_table(
+	const sprite_table& _table,
+	const std::string& _name,
+	std::ostream& _out
+) {
+
+	check_identifier(_name);
+	write_preamble(_out);
+
+	if(_table.size()) {
+
+		_out<<"inline constexpr ldtools::embedded_sprite_frame "<<_name<<"_frames[]={\n";
+		for(const auto& entry : _table) {
+
+			if(entry.first > std::numeric_limits<std::uint32_t>::max()) {
+
+				throw std::runtime_error(std::string{"sprite index "}+std::to_string(entry.first)+" is too large to be embedded");
+			}
+
+			const auto& f=entry.second;
+			_out<<"\t{"<<entry.first<<", "<<f.box.origin.x<<", "<<f.box.origin.y<<", "<<f.box.w<<"u, "<<f.box.h<<"u, "
+				<<f.disp_x<<", "<<f.disp_y<<", "<<f.flags<<"},\n";
+		}
+
+		_out<<"};\n\n"
+			<<"inline constexpr ldtools::embedded_sprite_table "<<_name<<"{"<<_name<<"_frames, "<<_table.size()<<"};\n";
+	}
+	else {
+
+		_out<<"inline constexpr ldtools::embedded_sprite_table "<<_name<<"{nullptr, 0};\n";
+	}
+}
+
+void ldtools::embed_animation_table(
+	const animation_table& _table,
+	const std::string& _name,
+	std::ostream& _out
+) {
+
+	check_identifier(_name);
+	write_preamble(_out);
+
+	const auto ids=_table.get_ids();
+	std::size_t line_count=0, event_count=0;
+	for(auto id : ids) {
+
+		const auto& anim=_table.get(id);
+		for(std::size_t i=0; i<anim.size(); i++) {
+
+			//Hexadecimal floats are written as inf or nan otherwise, which
+			//are not literals.
+			if(!std::isfinite(anim.get(i).duration)) {
+
+				throw std::runtime_error(std::string{"animation id "}+std::to_string(id)+" has a duration that cannot be embedded");
+			}
+
+			const auto events=anim.get_events(i);
+			event_count+=events.second-events.first;
+		}
+
+		line_count+=anim.size();
+	}
+
+	//Exact float literals, so durations are the same bits as when loaded.
+	_out<<std::hexfloat;
+
+	if(line_count) {
+
+		_out<<"inline constexpr ldtools::embedded_animation_line "<<_name<<"_lines[]={\n";
+		std::size_t events_before=0;
+		for(auto id : ids) {
+
+			const auto& anim=_table.get(id);
+			for(std::size_t i=0; i<anim.size(); i++) {
+
+				const auto& line=anim.get(i);
+				_out<<"\t{"<<line.duration<<"f, "<<line.frame_index<<"u, "<<events_before<<"u, "
+					<<line.event_count<<"u, "<<line.flags<<"},\n";
+				events_before+=line.event_count;
+			}
+		}
+
+		_out<<"};\n\n";
+	}
+
+	if(event_count) {
+
+		_out<<"inline constexpr const char * "<<_name<<"_events[]={\n";
+		for(auto id : ids) {
+
+			const auto& anim=_table.get(id);
+			for(std::size_t i=0; i<anim.size(); i++) {
+
+				const auto events=anim.get_events(i);
+				for(const auto * it=events.first; it!=events.second; ++it) {
+
+					_out<<"\t";
+					write_literal(_table.get_event_name(*it), _out);
+					_out<<",\n";
+				}
+			}
+		}
+
+		_out<<"};\n\n";
+	}
+
+	if(ids.size()) {
+
+		_out<<"inline constexpr ldtools::embedded_animation "<<_name<<"_animations[]={\n";
+		std::size_t lines_before=0;
+		for(auto id : ids) {
+
+			if(id > std::numeric_limits<std::uint32_t>::max()) {
+
+				throw std::runtime_error(std::string{"animation id "}+std::to_string(id)+" is too large to be embedded");
+			}
+
+			const auto& anim=_table.get(id);
+			_out<<"\t{"<<id<<"u, ";
+			write_literal(anim.get_name(), _out);
+			_out<<", "<<lines_before<<"u, "<<anim.size()<<"u},\n";
+			lines_before+=anim.size();
+		}
+
+		_out<<"};\n\n";
+	}
+
+	_out<<std::defaultfloat
+		<<"inline constexpr ldtools::embedded_animation_table "<<_name<<"{"
+		<<(ids.size() ? _name+"_animations" : "nullptr")<<", "<<ids.size()<<", "
+		<<(line_count ? _name+"_lines" : "nullptr")<<", "<<line_count<<", "
+		<<(event_count ? _name+"_events" : "nullptr")<<", "<<event_count<<"};\n";
+}
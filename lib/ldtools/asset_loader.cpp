@@ -0,0 +1,329 @@
+#include <ldtools/asset_loader.h>
+#include <ldtools/profiler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+using namespace ldtools;
+
+asset_loader::asset_loader(
+	std::size_t _threads
+)
+	:threads(_threads) {
+
+	if(!threads) {
+
+		threads=std::max(1u, std::thread::hardware_concurrency());
+	}
+}
+
+const sprite_table& asset_loader::get_sprite_table(const std::string& _id) const {
+
+	auto it=sprite_tables.find(_id);
+	if(it==sprite_tables.end()) {
+
+		throw asset_loader_exception("no sprite table with id "+_id);
+	}
+
+	return *(it->second);
+}
+
+const animation_table& asset_loader::get_animation_table(const std::string& _id) const {
+
+	auto it=animation_tables.find(_id);
+	if(it==animation_tables.end()) {
+
+		throw asset_loader_exception("no animation table with id "+_id);
+	}
+
+	return *(it->second);
+}
+
+std::vector<asset_loader::entry> asset_loader::read_manifest(
+	const std::string& _path
+) const {
+
+	std::ifstream file(_path);
+	if(!file) {
+
+		throw asset_loader_exception("unable to locate manifest "+_path);
+	}
+
+	std::vector<entry> result;
+	std::string line;
+	std::stringstream ss;
+	while(std::getline(file, line)) {
+
+		if(!line.size() || '#'==line[0]) {
+			continue;
+		}
+
+		ss.clear();
+		ss.str(line);
+
+		std::string kind;
+		entry e{};
+		ss>>kind;
+
+		if("sprite"==kind) {
+
+			e.kind=asset_load_time::kinds::sprite_table;
+			ss>>e.id>>e.path;
+		}
+		else if("animation"==kind) {
+
+			e.kind=asset_load_time::kinds::animation_table;
+			ss>>e.id>>e.path>>e.dependency;
+		}
+		else if("font"==kind) {
+
+			e.kind=asset_load_time::kinds::font;
+			ss>>e.id>>e.size>>e.path;
+
+			//An optional trailing option, not reading it is no failure.
+			std::string option;
+			if(!ss.fail()) {
+
+				if(ss>>option) {
+
+					if("lazy"!=option) {
+
+						throw asset_loader_exception("unknown font option '"+option+"' in manifest "+_path);
+					}
+
+					e.lazy=true;
+				}
+
+				ss.clear();
+			}
+		}
+		else if(kind.size()) {
+
+			throw asset_loader_exception("unknown asset kind '"+kind+"' in manifest "+_path);
+		}
+		else {
+
+			//Whitespace only.
+			continue;
+		}
+
+		if(ss.fail()) {
+
+			throw asset_loader_exception("malformed manifest line in "+_path+" : "+line);
+		}
+
+		result.push_back(e);
+	}
+
+	return result;
+}
+
+void asset_loader::load(
+	const std::string& _path,
+	ttf_manager& _fonts
+) {
+
+	LDTOOLS_PROFILE_ZONE("asset_loader::load");
+
+	using clock=std::chrono::steady_clock;
+	const auto start=clock::now();
+
+	sprite_tables.clear();
+	animation_tables.clear();
+	load_times.clear();
+	total_time=0.;
+
+	const auto entries=read_manifest(_path);
+
+	//All tables are built beforehand, so that animation tables can refer to
+	//their sprite tables and the workers never modify the maps.
+	std::map<std::string, std::vector<const entry *>> dependents;
+	std::vector<const entry *> sprites, fonts;
+
+	for(const auto& e : entries) {
+
+		if(asset_load_time::kinds::sprite_table!=e.kind) {
+			continue;
+		}
+
+		if(sprite_tables.count(e.id)) {
+
+			throw asset_loader_exception("repeated sprite table id "+e.id+" in manifest "+_path);
+		}
+
+		sprite_tables[e.id]=std::make_unique<sprite_table>();
+		dependents[e.id];
+		sprites.push_back(&e);
+	}
+
+	for(const auto& e : entries) {
+
+		if(asset_load_time::kinds::font==e.kind) {
+
+			fonts.push_back(&e);
+			continue;
+		}
+
+		if(asset_load_time::kinds::animation_table!=e.kind) {
+			continue;
+		}
+
+		if(animation_tables.count(e.id)) {
+
+			throw asset_loader_exception("repeated animation table id "+e.id+" in manifest "+_path);
+		}
+
+		if(!sprite_tables.count(e.dependency)) {
+
+			throw asset_loader_exception("animation table "+e.id+" uses unknown sprite table "+e.dependency);
+		}
+
+		animation_tables[e.id]=std::make_unique<animation_table>(*sprite_tables[e.dependency]);
+		dependents[e.dependency].push_back(&e);
+	}
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<std::function<void()>> queue;
+	std::size_t pending=sprites.size()+animation_tables.size();
+	std::string error;
+
+	auto record=[&](const entry& _entry, clock::time_point _start, bool _main_thread) {
+
+		const std::chrono::duration<double, std::milli> elapsed=clock::now()-_start;
+		std::lock_guard<std::mutex> lock(mutex);
+		load_times.push_back({_entry.kind, _entry.id, _entry.path, elapsed.count(), _main_thread});
+	};
+
+	auto fail=[&](const entry& _entry, const std::string& _what, std::size_t _skipped) {
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if(!error.size()) {
+
+			error="unable to load "+_entry.id+" from "+_entry.path+" : "+_what;
+		}
+
+		pending-=_skipped;
+	};
+
+	auto load_animation=[&](const entry& _entry) {
+
+		try {
+			const auto task_start=clock::now();
+			animation_tables.at(_entry.id)->load(_entry.path);
+			record(_entry, task_start, false);
+		}
+		catch(std::exception& e) {
+
+			fail(_entry, e.what(), 0);
+		}
+	};
+
+	auto load_sprite=[&](const entry& _entry) {
+
+		const auto& waiting=dependents.at(_entry.id);
+
+		try {
+			const auto task_start=clock::now();
+			sprite_tables.at(_entry.id)->load(_entry.path);
+			record(_entry, task_start, false);
+		}
+		catch(std::exception& e) {
+
+			//Its animation tables will never be loaded.
+			fail(_entry, e.what(), waiting.size());
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		for(const auto * dependent : waiting) {
+
+			queue.push_back([&load_animation, dependent]() {load_animation(*dependent);});
+		}
+
+		condition.notify_all();
+	};
+
+	for(const auto * e : sprites) {
+
+		queue.push_back([&load_sprite, e]() {load_sprite(*e);});
+	}
+
+	auto work=[&]() {
+
+		LDTOOLS_PROFILE_THREAD("asset_loader worker");
+
+		while(true) {
+
+			std::function<void()> task;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [&]() {return queue.size() || !pending;});
+
+				if(!pending) {
+
+					return;
+				}
+
+				task=std::move(queue.front());
+				queue.pop_front();
+			}
+
+			task();
+
+			std::lock_guard<std::mutex> lock(mutex);
+			--pending;
+			condition.notify_all();
+		}
+	};
+
+	std::vector<std::thread> workers;
+	const std::size_t worker_count=std::min(threads, pending);
+	for(std::size_t i=0; i<worker_count; i++) {
+
+		workers.emplace_back(work);
+	}
+
+	//Fonts are created here while the workers parse.
+	for(const auto * e : fonts) {
+
+		if(e->lazy) {
+
+			_fonts.insert_lazy(e->id, e->size, e->path);
+			continue;
+		}
+
+		try {
+			const auto task_start=clock::now();
+			_fonts.insert(e->id, e->size, e->path);
+			record(*e, task_start, true);
+		}
+		catch(std::exception& ex) {
+
+			fail(*e, ex.what(), 0);
+			break;
+		}
+	}
+
+	for(auto& worker : workers) {
+
+		worker.join();
+	}
+
+	total_time=std::chrono::duration<double, std::milli>(clock::now()-start).count();
+
+	if(error.size()) {
+
+		sprite_tables.clear();
+		animation_tables.clear();
+		throw asset_loader_exception(error);
+	}
+}
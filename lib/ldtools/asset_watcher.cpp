@@ -0,0 +1,203 @@
+#include <ldtools/asset_watcher.h>
+
+#include <set>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace ldtools;
+
+#ifdef __linux__
+
+asset_watcher::asset_watcher() {
+
+	fd=inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if(-1==fd) {
+
+		throw asset_watcher_exception("unable to initialize inotify");
+	}
+}
+
+asset_watcher::~asset_watcher() {
+
+	close(fd);
+}
+
+asset_watcher::directory& asset_watcher::directory_for(
+	const std::string& _path,
+	std::string& _filename
+) {
+
+	const auto slash=_path.find_last_of('/');
+	const std::string dirname=std::string::npos==slash ? "." : _path.substr(0, slash+1);
+	_filename=std::string::npos==slash ? _path : _path.substr(slash+1);
+
+	//Watching the same directory again returns the same descriptor. New
+	//files are not read on creation, when they are still empty, but once
+	//closed after writing or moved in.
+	const int wd=inotify_add_watch(fd, dirname.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	if(-1==wd) {
+
+		throw asset_watcher_exception("unable to watch directory "+dirname);
+	}
+
+	auto& result=directories[wd];
+	result.path=std::string::npos==slash ? "" : dirname;
+	return result;
+}
+
+void asset_watcher::watch(
+	sprite_table& _table,
+	const std::string& _path
+) {
+
+	std::string filename;
+	directory_for(_path, filename).sprites[filename].push_back(&_table);
+}
+
+void asset_watcher::watch(
+	animation_table& _table,
+	const std::string& _path
+) {
+
+	std::string filename;
+	directory_for(_path, filename).animations[filename].push_back(&_table);
+	all_animations.push_back(&_table);
+}
+
+std::vector<asset_reload> asset_watcher::poll() {
+
+	//Editors usually trigger many events per save: collect them first.
+	std::set<std::pair<int, std::string>> changed;
+	alignas(inotify_event) char buffer[4096];
+
+	while(true) {
+
+		const auto length=read(fd, buffer, sizeof(buffer));
+		if(length <= 0) {
+
+			break;
+		}
+
+		for(const char * ptr=buffer; ptr < buffer+length;) {
+
+			const auto * event=reinterpret_cast<const inotify_event *>(ptr);
+			if(event->len) {
+
+				changed.insert({event->wd, event->name});
+			}
+
+			ptr+=sizeof(inotify_event)+event->len;
+		}
+	}
+
+	std::vector<asset_reload> result;
+
+	//Sprite tables go first, so reloaded animations get the new frames.
+	for(const auto& change : changed) {
+
+		const auto& dir=directories.at(change.first);
+		auto it=dir.sprites.find(change.second);
+		if(it==std::end(dir.sprites)) {
+
+			continue;
+		}
+
+		const std::string path=dir.path+change.second;
+		for(auto * table : it->second) {
+
+			try {
+
+				//Animations that would lose frames in use refuse the
+				//reload before anything changes.
+				auto check=[this, table](const sprite_table& _fresh, const std::vector<size_t>& _changed) {
+
+					for(auto * animations : all_animations) {
+
+						if(&animations->get_table()==table) {
+
+							animations->check_frames(_fresh, _changed);
+						}
+					}
+				};
+
+				const auto indexes=table->reload(path, check);
+				for(auto * animations : all_animations) {
+
+					if(&animations->get_table()==table) {
+
+						animations->refresh_frames(indexes);
+					}
+				}
+
+				result.push_back({path, true, "", indexes.size()});
+			}
+			catch(std::exception& e) {
+
+				result.push_back({path, false, e.what(), 0});
+			}
+		}
+	}
+
+	for(const auto& change : changed) {
+
+		const auto& dir=directories.at(change.first);
+		auto it=dir.animations.find(change.second);
+		if(it==std::end(dir.animations)) {
+
+			continue;
+		}
+
+		const std::string path=dir.path+change.second;
+		for(auto * table : it->second) {
+
+			try {
+
+				result.push_back({path, true, "", table->reload(path).size()});
+			}
+			catch(std::exception& e) {
+
+				result.push_back({path, false, e.what(), 0});
+			}
+		}
+	}
+
+	return result;
+}
+
+#else
+
+asset_watcher::asset_watcher() {
+
+	throw asset_watcher_exception("the asset watcher needs inotify, which is not available");
+}
+
+asset_watcher::~asset_watcher() {
+
+}
+
+asset_watcher::directory& asset_watcher::directory_for(
+	const std::string&,
+	std::string&
+) {
+
+	throw asset_watcher_exception("the asset watcher needs inotify, which is not available");
+}
+
+void asset_watcher::watch(sprite_table&, const std::string&) {
+
+}
+
+void asset_watcher::watch(animation_table&, const std::string&) {
+
+}
+
+std::vector<asset_reload> asset_watcher::poll() {
+
+	return {};
+}
+
+#endif
@@ -0,0 +1,402 @@
+#include <ldtools/atlas_packer.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <tuple>
+#include <unordered_map>
+
+using namespace ldtools;
+
+atlas_packer::atlas_packer(
+	const atlas_options& _options
+)
+	:options(_options) {
+
+	if(!options.page_sizes.size()) {
+
+		throw atlas_packer_exception("at least one page size is needed");
+	}
+}
+
+atlas_layout atlas_packer::layout(
+	const sprite_table& _table,
+	unsigned _w,
+	unsigned _h
+) const {
+
+	auto regions=regions_for(_table);
+	return build(_table, regions, (std::size_t)_w * _h * 4);
+}
+
+atlas atlas_packer::pack(
+	const sprite_table& _table,
+	SDL_Surface * _surface
+) const {
+
+	if(!_surface) {
+
+		throw atlas_packer_exception("cannot pack without a source surface");
+	}
+
+	//Everything is done in RGBA so pixels can be compared and copied as is.
+	atlas_surface source{SDL_ConvertSurfaceFormat(_surface, SDL_PIXELFORMAT_RGBA32, 0), SDL_FreeSurface};
+	if(!source) {
+
+		throw atlas_packer_exception(std::string{"unable to convert source surface: "}+SDL_GetError());
+	}
+
+	auto regions=regions_for(_table);
+
+	if(SDL_MUSTLOCK(source.get())) {
+
+		SDL_LockSurface(source.get());
+	}
+
+	const auto * pixels=static_cast<const unsigned char *>(source->pixels);
+	const int pitch=source->pitch;
+
+	auto row=[pixels, pitch](const ldv::rect& _box, unsigned _y) {
+
+		return pixels+(_box.origin.y+_y)*pitch+_box.origin.x*4;
+	};
+
+	for(auto& r : regions) {
+
+		const auto& box=r.source;
+		if(box.origin.x < 0 || box.origin.y < 0
+			|| box.origin.x+box.w > (unsigned)source->w
+			|| box.origin.y+box.h > (unsigned)source->h
+		) {
+
+			if(SDL_MUSTLOCK(source.get())) {
+
+				SDL_UnlockSurface(source.get());
+			}
+
+			throw atlas_packer_exception("frame "+std::to_string(r.frames.front())+" falls outside the source surface");
+		}
+
+		//FNV-1a over the rows.
+		std::size_t hash=14695981039346656037ull;
+		for(unsigned y=0; y<box.h; y++) {
+
+			const auto * ptr=row(box, y);
+			for(unsigned i=0; i<box.w*4; i++) {
+
+				hash=(hash ^ ptr[i]) * 1099511628211ull;
+			}
+		}
+
+		r.hash=hash;
+	}
+
+	if(options.deduplicate) {
+
+		auto same_pixels=[&row](const ldv::rect& _a, const ldv::rect& _b) {
+
+			if(_a.w!=_b.w || _a.h!=_b.h) {
+
+				return false;
+			}
+
+			for(unsigned y=0; y<_a.h; y++) {
+
+				if(std::memcmp(row(_a, y), row(_b, y), _a.w*4)) {
+
+					return false;
+				}
+			}
+
+			return true;
+		};
+
+		std::vector<region> unique;
+		std::unordered_multimap<std::size_t, std::size_t> by_hash;
+		for(auto& r : regions) {
+
+			const auto candidates=by_hash.equal_range(r.hash);
+			auto it=std::find_if(candidates.first, candidates.second, [&](const std::pair<const std::size_t, std::size_t>& _candidate) {
+
+				return same_pixels(unique[_candidate.second].source, r.source);
+			});
+
+			if(it==candidates.second) {
+
+				by_hash.emplace(r.hash, unique.size());
+				unique.push_back(std::move(r));
+			}
+			else {
+
+				auto& target=unique[it->second].frames;
+				target.insert(std::end(target), std::begin(r.frames), std::end(r.frames));
+			}
+		}
+
+		regions=std::move(unique);
+	}
+
+	if(SDL_MUSTLOCK(source.get())) {
+
+		SDL_UnlockSurface(source.get());
+	}
+
+	atlas result{build(_table, regions, (std::size_t)source->w * source->h * 4), {}};
+
+	for(std::size_t i=0; i<result.layout.page_count; i++) {
+
+		atlas_surface page{
+			SDL_CreateRGBSurfaceWithFormat(0, result.layout.page_size.w, result.layout.page_size.h, 32, SDL_PIXELFORMAT_RGBA32),
+			SDL_FreeSurface
+		};
+
+		if(!page) {
+
+			throw atlas_packer_exception(std::string{"unable to create atlas page: "}+SDL_GetError());
+		}
+
+		SDL_FillRect(page.get(), nullptr, 0);
+		result.pages.push_back(std::move(page));
+	}
+
+	//Copy pixels as they are, alpha included.
+	SDL_SetSurfaceBlendMode(source.get(), SDL_BLENDMODE_NONE);
+	for(const auto& r : regions) {
+
+		if(!r.source.w || !r.source.h) {
+			continue;
+		}
+
+		SDL_Rect from{r.source.origin.x, r.source.origin.y, (int)r.source.w, (int)r.source.h},
+			to{r.position.x, r.position.y, (int)r.source.w, (int)r.source.h};
+
+		if(SDL_BlitSurface(source.get(), &from, result.pages[r.page].get(), &to)) {
+
+			throw atlas_packer_exception(std::string{"unable to copy frame: "}+SDL_GetError());
+		}
+	}
+
+	return result;
+}
+
+std::vector<atlas_packer::region> atlas_packer::regions_for(
+	const sprite_table& _table
+) const {
+
+	std::vector<region> result;
+	std::map<std::tuple<int, int, unsigned, unsigned>, std::size_t> by_box;
+
+	for(const auto& entry : _table) {
+
+		const auto& box=entry.second.box;
+		const auto key=std::make_tuple(box.origin.x, box.origin.y, box.w, box.h);
+
+		if(options.deduplicate && by_box.count(key)) {
+
+			result[by_box[key]].frames.push_back(entry.first);
+			continue;
+		}
+
+		by_box[key]=result.size();
+		result.push_back({box, {entry.first}, 0, {}, 0});
+	}
+
+	return result;
+}
+
+std::size_t atlas_packer::place(
+	std::vector<region *>& _regions,
+	atlas_page_size _size
+) const {
+
+	//The skyline is the top edge of what has been placed in the current
+	//page, as segments from left to right.
+	struct segment {
+		unsigned x, y, w;
+	};
+
+	std::vector<segment> skyline{{0, 0, _size.w}};
+	std::size_t page=0;
+	const unsigned padding=options.padding;
+
+	//Returns the lowest y where a rectangle would rest if its left side were
+	//at the start of the given segment, or the page height if it does not
+	//fit.
+	auto rest_at=[&skyline, _size](std::size_t _index, unsigned _w, unsigned _h) {
+
+		if(skyline[_index].x+_w > _size.w) {
+
+			return _size.h;
+		}
+
+		unsigned y=0, covered=0;
+		for(std::size_t i=_index; covered < _w; i++) {
+
+			y=std::max(y, skyline[i].y);
+			covered+=skyline[i].w;
+		}
+
+		return y+_h > _size.h ? _size.h : y;
+	};
+
+	for(auto * r : _regions) {
+
+		const unsigned w=r->source.w+padding,
+			h=r->source.h+padding;
+
+		if(r->source.w > _size.w || r->source.h > _size.h) {
+
+			return 0;
+		}
+
+		std::size_t best=skyline.size();
+		unsigned best_y=_size.h;
+
+		for(std::size_t i=0; i<skyline.size(); i++) {
+
+			const unsigned y=rest_at(i, std::min(w, _size.w), std::min(h, _size.h));
+			if(y < best_y) {
+
+				best=i;
+				best_y=y;
+			}
+		}
+
+		if(best==skyline.size()) {
+
+			//Next page.
+			skyline={{0, 0, _size.w}};
+			++page;
+			best=0;
+			best_y=0;
+		}
+
+		const unsigned x=skyline[best].x,
+			right=std::min(x+w, _size.w);
+
+		r->page=page;
+		r->position={(int)x, (int)best_y};
+
+		//Raise the skyline under the rectangle.
+		std::vector<segment> raised;
+		for(const auto& s : skyline) {
+
+			const unsigned s_right=s.x+s.w;
+			if(s_right <= x || s.x >= right) {
+
+				raised.push_back(s);
+				continue;
+			}
+
+			if(s.x < x) {
+
+				raised.push_back({s.x, s.y, x-s.x});
+			}
+
+			if(s.x <= x) {
+
+				raised.push_back({x, best_y+h, right-x});
+			}
+
+			if(s_right > right) {
+
+				raised.push_back({right, s.y, s_right-right});
+			}
+		}
+
+		//Merge neighbours at the same height.
+		skyline.clear();
+		for(const auto& s : raised) {
+
+			if(skyline.size() && skyline.back().y==s.y) {
+
+				skyline.back().w+=s.w;
+			}
+			else {
+
+				skyline.push_back(s);
+			}
+		}
+	}
+
+	return page+1;
+}
+
+atlas_layout atlas_packer::build(
+	const sprite_table& _table,
+	std::vector<region>& _regions,
+	std::size_t _source_bytes
+) const {
+
+	std::vector<region *> sorted;
+	for(auto& r : _regions) {
+
+		if(r.source.w && r.source.h) {
+
+			sorted.push_back(&r);
+		}
+	}
+
+	std::stable_sort(std::begin(sorted), std::end(sorted), [](const region * _a, const region * _b) {
+
+		return _a->source.h==_b->source.h
+			? _a->source.w > _b->source.w
+			: _a->source.h > _b->source.h;
+	});
+
+	std::size_t best_bytes=std::numeric_limits<std::size_t>::max(),
+		best_pages=0;
+	atlas_page_size best_size{0, 0};
+
+	for(const auto& size : options.page_sizes) {
+
+		const auto pages=place(sorted, size);
+		const std::size_t bytes=pages * size.w * size.h * 4;
+		if(pages && bytes < best_bytes) {
+
+			best_bytes=bytes;
+			best_pages=pages;
+			best_size=size;
+		}
+	}
+
+	if(!best_pages && sorted.size()) {
+
+		throw atlas_packer_exception("frames do not fit in any of the page sizes");
+	}
+
+	//Place again with the winner, as the regions hold the last attempt.
+	if(sorted.size()) {
+
+		place(sorted, best_size);
+	}
+
+	atlas_layout result;
+	sprite_table::container frames;
+	std::size_t frame_count=0;
+
+	for(const auto& r : _regions) {
+
+		for(auto index : r.frames) {
+
+			auto frame=_table.get(index);
+			if(r.source.w && r.source.h) {
+
+				frame.box.origin=r.position;
+				result.pages[index]=r.page;
+			}
+
+			frames[index]=frame;
+			++frame_count;
+		}
+	}
+
+	result.table=sprite_table{frames, _table.get_storage()==sprite_table::storage::dense ? sprite_table::storage::dense : sprite_table::storage::map};
+	result.page_size=best_size;
+	result.page_count=sorted.size() ? best_pages : 0;
+	result.regions=sorted.size();
+	result.duplicates=frame_count-_regions.size();
+	result.source_bytes=_source_bytes;
+	result.atlas_bytes=result.page_count * best_size.w * best_size.h * 4;
+	return result;
+}
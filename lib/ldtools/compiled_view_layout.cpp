@@ -0,0 +1,203 @@
+#include <ldtools/compiled_view_layout.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+using namespace ldtools;
+
+compiled_view_layout::compiled_view_layout(
+	const std::string& _path
+)
+try:
+	file(_path) {
+
+	static_assert(std::is_trivially_copyable<compiled_view_token>::value, "compiled view tokens must be trivially copyable");
+
+	auto fail=[&_path](const std::string& _reason) {
+
+		throw std::runtime_error(std::string{"Invalid compiled view layout "}+_path+" : "+_reason);
+	};
+
+	using header_type=compiled_view_layout_header;
+	const std::uint64_t file_size=file.size();
+
+	if(file_size < sizeof(header_type)) {
+
+		fail("too short");
+	}
+
+	header=reinterpret_cast<const header_type *>(file.data());
+
+	if(header_type::magic_value!=header->magic) {
+
+		fail("not a compiled view layout");
+	}
+
+	if(header_type::version_value!=header->version) {
+
+		fail("unsupported version");
+	}
+
+	if(header_type::endianness_value!=header->endianness
+		|| sizeof(compiled_view_token)!=header->token_size
+	) {
+
+		fail("compiled for a different platform");
+	}
+
+	auto block_fits=[file_size](std::uint64_t _offset, std::uint64_t _count, std::uint64_t _size, std::uint64_t _alignment) {
+
+		return 0==_offset % _alignment
+			&& _offset <= file_size
+			&& _count * _size <= file_size - _offset;
+	};
+
+	if(!block_fits(header->layouts_offset, header->layout_count, sizeof(compiled_view_layout_entry), alignof(compiled_view_layout_entry))
+		|| !block_fits(header->tokens_offset, header->token_count, sizeof(compiled_view_token), alignof(compiled_view_token))
+		|| !block_fits(header->strings_offset, header->string_count, sizeof(compiled_view_string), alignof(compiled_view_string))
+		|| !block_fits(header->characters_offset, header->characters_size, 1, 1)
+		|| !block_fits(header->points_offset, header->point_count, sizeof(compiled_view_point), alignof(compiled_view_point))
+	) {
+
+		fail("bad offsets");
+	}
+
+	const char * begin=file.data();
+	layouts=reinterpret_cast<const compiled_view_layout_entry *>(begin+header->layouts_offset);
+	tokens=reinterpret_cast<const compiled_view_token *>(begin+header->tokens_offset);
+	strings=reinterpret_cast<const compiled_view_string *>(begin+header->strings_offset);
+	characters=begin+header->characters_offset;
+	points=reinterpret_cast<const compiled_view_point *>(begin+header->points_offset);
+
+	//Everything is checked once here so reading tokens needs no checks.
+	for(std::uint32_t i=0; i<header->string_count; i++) {
+
+		if(strings[i].offset > header->characters_size
+			|| strings[i].size > header->characters_size - strings[i].offset
+		) {
+
+			fail("bad string "+std::to_string(i));
+		}
+	}
+
+	auto valid_string=[this](std::uint32_t _index, bool _optional) {
+
+		return _index < header->string_count
+			|| (_optional && compiled_view_token::no_string==_index);
+	};
+
+	for(std::uint32_t i=0; i<header->token_count; i++) {
+
+		const auto& token=tokens[i];
+		if(token.type > static_cast<std::uint8_t>(view_token::types::definition)
+			|| !valid_string(token.id, true)
+			|| !valid_string(token.resource, true)
+			|| !valid_string(token.text, true)
+			|| token.first_point > header->point_count
+			|| token.point_count > header->point_count - token.first_point
+		) {
+
+			fail("bad token "+std::to_string(i));
+		}
+	}
+
+	for(std::uint32_t i=0; i<header->layout_count; i++) {
+
+		const auto& layout=layouts[i];
+		if(!valid_string(layout.name, false)
+			|| layout.first > header->token_count
+			|| layout.count > header->token_count - layout.first
+			|| (i && !(string(layouts[i-1].name) < string(layout.name)))
+		) {
+
+			fail("bad layout "+std::to_string(i));
+		}
+	}
+}
+catch(mapped_file_exception&) {
+
+	throw std::runtime_error(std::string{"Unable to locate compiled view layout "}+_path);
+}
+
+bool compiled_view_layout::has_layout(
+	std::string_view _name
+) const {
+
+	return nullptr!=lookup(_name);
+}
+
+std::pair<std::size_t, std::size_t> compiled_view_layout::find(
+	std::string_view _name
+) const {
+
+	const auto * layout=lookup(_name);
+	if(nullptr==layout) {
+
+		throw std::runtime_error(std::string{"Unable to locate layout "}+std::string{_name}+" in compiled view layout");
+	}
+
+	return {layout->first, layout->first+layout->count};
+}
+
+void compiled_view_layout::read(
+	std::size_t _index,
+	view_token& _token
+) const {
+
+	const auto& source=tokens[_index];
+
+	_token.clear();
+	_token.type=static_cast<view_token::types>(source.type);
+	_token.flag_set=source.flags;
+	_token.order=source.order;
+	_token.alpha=source.alpha;
+	std::copy(std::begin(source.rotation), std::end(source.rotation), std::begin(_token.rotation));
+	std::copy(std::begin(source.location), std::end(source.location), std::begin(_token.location));
+	std::copy(std::begin(source.clip), std::end(source.clip), std::begin(_token.clip));
+	std::copy(std::begin(source.brush), std::end(source.brush), std::begin(_token.brush));
+	std::copy(std::begin(source.rgba), std::end(source.rgba), std::begin(_token.rgba));
+	_token.int_value=source.int_value;
+	_token.float_value=source.float_value;
+	_token.ratio=source.ratio;
+	_token.id=string(source.id);
+	_token.resource=string(source.resource);
+	_token.text=string(source.text);
+
+	const auto * point=points+source.first_point;
+	for(std::uint32_t i=0; i<source.point_count; i++, point++) {
+
+		_token.points.push_back({point->x, point->y});
+	}
+}
+
+const compiled_view_layout_entry * compiled_view_layout::lookup(
+	std::string_view _name
+) const {
+
+	const auto * end=layouts+header->layout_count;
+	const auto * it=std::lower_bound(
+		layouts,
+		end,
+		_name,
+		[this](const compiled_view_layout_entry& _entry, std::string_view _value) {
+			return string(_entry.name) < _value;
+		}
+	);
+
+	return it!=end && string(it->name)==_name
+		? it
+		: nullptr;
+}
+
+std::string_view compiled_view_layout::string(
+	std::uint32_t _index
+) const {
+
+	if(compiled_view_token::no_string==_index) {
+
+		return {};
+	}
+
+	return {characters+strings[_index].offset, strings[_index].size};
+}
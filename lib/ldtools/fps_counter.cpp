@@ -1,10 +1,22 @@
 #include <ldtools/fps_counter.h>
 
+#include <cmath>
+
 using namespace ldtools;
 
 fps_counter::fps_counter():
-	ticks_count(t_clock::now()), 
+	ticks_count(clock().now()), 
+	ticks_produce(ticks_count),
+	ticks_step(ticks_count),
+	frame_count(0), internal_count(0) {
+
+}
+
+fps_counter::fps_counter(time_source& _source):
+	source(&_source),
+	ticks_count(clock().now()), 
 	ticks_produce(ticks_count),
+	ticks_step(ticks_count),
 	frame_count(0), internal_count(0) {
 
 }
@@ -13,36 +25,39 @@ void fps_counter::loop_step() {
 
 	++internal_count;
 
-	//We check if a second has elapsed, to reset the framecount... Integral duration: requires duration_cast
-	auto int_ms=std::chrono::duration_cast<std::chrono::milliseconds>(t_clock::now() - ticks_count);
+	const auto now=clock().now();
+	stats.add(std::chrono::duration<tdelta>(now - ticks_step).count());
+	ticks_step=now;
 
-	if(int_ms.count() > 1000) {
-		//TODO: There's a slight chance this would NOT be accurate... int_ms.count could be 2000, for example.
-		ticks_count=t_clock::now();
-		frame_count=internal_count;
+	//We check if a second has elapsed, to reset the framecount. Long counts
+	//(a second frame that took two, for example) are scaled to one second.
+	const std::chrono::duration<tdelta> elapsed=now - ticks_count;
+
+	if(elapsed.count() > 1.) {
+		ticks_count=now;
+		frame_count=std::lround(internal_count / elapsed.count());
 		internal_count=0;
 	}
 }
 
 void fps_counter::fill_until(tdelta& produced, tdelta pdelta) {
 
-	auto start=t_clock::now();
-	tdelta diff=pdelta-produced, curr=0.;
-	while(curr < diff) {
+	if(produced < pdelta) {
 
-		curr=std::chrono::duration_cast<std::chrono::milliseconds>(t_clock::now() - start).count() / 1000.f;
+		auto& c=clock();
+		const auto start=c.now();
+		c.wait_until(start+std::chrono::duration_cast<time_source::duration>(std::chrono::duration<tdelta>(pdelta-produced)));
+		produced+=std::chrono::duration<tdelta>(c.now() - start).count();
 	}
-
-	produced+=curr;
 }
 
 void fps_counter::begin_time_produce() {
 
-	ticks_produce=t_clock::now();
+	ticks_produce=clock().now();
 }
 
 tdelta fps_counter::end_time_produce() {
 
-	auto int_ms=std::chrono::duration_cast<std::chrono::milliseconds>(t_clock::now() - ticks_produce);
-	return int_ms.count() / 1000.0;
+	const std::chrono::duration<tdelta> elapsed=clock().now() - ticks_produce;
+	return elapsed.count();
 }
@@ -0,0 +1,147 @@
+#include <ldtools/frame_limiter.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <thread>
+
+#ifdef __linux__
+#include <time.h>
+#endif
+
+using namespace ldtools;
+
+namespace {
+
+constexpr std::chrono::microseconds     min_margin{50},
+                                        max_margin{4000},
+                                        initial_margin{1000};
+}
+
+double frame_limiter_stats::jitter() const {
+
+	if(!waits) {
+
+		return 0.;
+	}
+
+	const double mean=mean_error();
+	return std::sqrt(std::max(0., error_squares / waits - mean * mean));
+}
+
+frame_limiter::frame_limiter(
+	tdelta _frame_time
+)
+	:margin(initial_margin),
+	deadline(clock::now()),
+	last_wait(deadline) {
+
+	set_frame_time(_frame_time);
+}
+
+void frame_limiter::set_frame_time(
+	tdelta _frame_time
+) {
+
+	frame_time=std::chrono::duration_cast<clock::duration>(std::chrono::duration<tdelta>(_frame_time));
+}
+
+tdelta frame_limiter::wait() {
+
+	deadline+=frame_time;
+
+	const auto now=clock::now();
+	if(now > deadline+frame_time) {
+
+		deadline=now;
+	}
+	else {
+
+		wait_until(deadline);
+	}
+
+	const auto end=clock::now();
+	const std::chrono::duration<tdelta> elapsed=end-last_wait;
+	last_wait=end;
+	return elapsed.count();
+}
+
+tdelta frame_limiter::wait_for(
+	tdelta _seconds
+) {
+
+	const auto start=clock::now();
+	wait_until(start+std::chrono::duration_cast<clock::duration>(std::chrono::duration<tdelta>(_seconds)));
+	const std::chrono::duration<tdelta> elapsed=clock::now()-start;
+	return elapsed.count();
+}
+
+void frame_limiter::wait_until(
+	clock::time_point _deadline
+) {
+
+	auto now=clock::now();
+	if(now >= _deadline) {
+
+		return;
+	}
+
+	const auto wake=_deadline-margin;
+	if(now < wake) {
+
+		sleep_until(wake);
+		const auto woken=clock::now();
+		stats.sleep_seconds+=std::chrono::duration<double>(woken-now).count();
+
+		//Grow fast to what the system overslept, shrink slowly.
+		const auto overslept=woken-wake;
+		margin=std::max<clock::duration>(overslept+overslept / 2, margin-margin / 16);
+		margin=std::min<clock::duration>(std::max<clock::duration>(margin, min_margin), max_margin);
+		now=woken;
+	}
+
+	const auto spin_start=now;
+	while(now < _deadline) {
+
+		now=clock::now();
+	}
+
+	stats.spin_seconds+=std::chrono::duration<double>(now-spin_start).count();
+
+	const double late=std::chrono::duration<double>(now-_deadline).count();
+	++stats.waits;
+	stats.error_sum+=late;
+	stats.error_squares+=late * late;
+	stats.max_error=std::max(stats.max_error, late);
+}
+
+#ifdef __linux__
+
+void frame_limiter::sleep_until(
+	clock::time_point _when
+) {
+
+	//steady_clock is CLOCK_MONOTONIC, so its time points can be used as
+	//absolute deadlines, which do not drift when a sleep is interrupted.
+	const auto since_epoch=_when.time_since_epoch();
+	const auto seconds=std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+
+	timespec ts;
+	ts.tv_sec=seconds.count();
+	ts.tv_nsec=std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch-seconds).count();
+
+	while(EINTR==clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr)) {
+
+	}
+}
+
+#else
+
+void frame_limiter::sleep_until(
+	clock::time_point _when
+) {
+
+	std::this_thread::sleep_until(_when);
+}
+
+#endif
@@ -0,0 +1,218 @@
+#include <ldtools/frame_stats.h>
+
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+#include <stdexcept>
+
+using namespace ldtools;
+
+namespace {
+
+//!The first bucket ends at 2^-13 seconds (about 0.12 ms), the last one
+//!starts at 2^0.5 (about 1.4 s).
+const int lowest_octave=-13;
+
+//!Nearest rank of the percentile among the given number of samples, which
+//!cannot be zero.
+std::size_t rank_for(
+	double _percentile,
+	std::size_t _count
+) {
+
+	const double rank=std::ceil(std::clamp(_percentile, 0., 100.) / 100. * _count-1.);
+	return std::min<std::size_t>(_count-1, std::max(0., rank));
+}
+}
+
+frame_stats::frame_stats(
+	std::size_t _window,
+	tdelta _budget
+)
+	:samples(_window), histogram(bucket_count, 0), budget(_budget) {
+
+	if(!_window) {
+
+		throw std::runtime_error("frame_stats window cannot be empty");
+	}
+
+	scratch.reserve(_window);
+}
+
+void frame_stats::add(
+	tdelta _duration
+) {
+
+	const float value=_duration;
+
+	//Once in the sum, they could never be taken out of it.
+	if(!(std::isfinite(value) && value >= 0.f)) {
+
+		return;
+	}
+
+	if(count==samples.size()) {
+
+		const float old=samples[next];
+		sum-=old;
+		--histogram[bucket(old)];
+		hitches-=old > budget;
+	}
+	else {
+
+		++count;
+	}
+
+	samples[next]=value;
+	next=next+1==samples.size() ? 0 : next+1;
+
+	sum+=value;
+	++histogram[bucket(value)];
+
+	const bool hitch=value > budget;
+	hitches+=hitch;
+	total_hitches+=hitch;
+	++total_frames;
+}
+
+void frame_stats::clear() {
+
+	std::fill(std::begin(histogram), std::end(histogram), 0);
+	next=count=hitches=0;
+	total_frames=total_hitches=0;
+	sum=0.;
+}
+
+void frame_stats::set_budget(
+	tdelta _budget
+) {
+
+	budget=_budget;
+	const auto window=get_samples();
+	hitches=std::count_if(std::begin(window), std::end(window), [this](float _value) {return _value > budget;});
+}
+
+tdelta frame_stats::percentile(
+	double _percentile
+) const {
+
+	if(std::isnan(_percentile)) {
+
+		throw std::runtime_error("frame_stats percentile cannot be NaN");
+	}
+
+	if(!count) {
+
+		return 0.;
+	}
+
+	scratch=get_samples();
+	const auto rank=rank_for(_percentile, count);
+	std::nth_element(std::begin(scratch), std::begin(scratch)+rank, std::end(scratch));
+	return scratch[rank];
+}
+
+frame_stats_summary frame_stats::summary() const {
+
+	frame_stats_summary result;
+	result.frames=count;
+	result.hitches=hitches;
+
+	if(!count) {
+
+		return result;
+	}
+
+	scratch=get_samples();
+	std::sort(std::begin(scratch), std::end(scratch));
+
+	auto at=[this](double _percentile) -> tdelta {
+
+		return scratch[rank_for(_percentile, count)];
+	};
+
+	result.min=scratch.front();
+	result.max=scratch.back();
+	result.mean=mean();
+	result.p50=at(50.);
+	result.p95=at(95.);
+	result.p99=at(99.);
+	return result;
+}
+
+tdelta frame_stats::bucket_lower(
+	std::size_t _bucket
+) {
+
+	if(!_bucket) {
+
+		return 0.;
+	}
+
+	return std::exp2(lowest_octave+(tdelta)(_bucket-1) / buckets_per_octave);
+}
+
+std::size_t frame_stats::bucket(
+	float _value
+) {
+
+	if(!(_value > 0.f)) {
+
+		return 0;
+	}
+
+	//frexp gives the octave without a logarithm, the fraction in [0.5, 1)
+	//is split in even parts of the octave on a log scale.
+	int exponent=0;
+	const float fraction=std::frexp(_value, &exponent);
+	const int quarter=fraction < 0.70710678f
+		? (fraction < 0.59460356f ? 0 : 1)
+		: (fraction < 0.84089642f ? 2 : 3);
+
+	const int index=(exponent-1-lowest_octave) * (int)buckets_per_octave+quarter+1;
+	return std::clamp(index, 0, (int)bucket_count-1);
+}
+
+std::vector<float> frame_stats::get_samples() const {
+
+	std::vector<float> result;
+	result.reserve(count);
+
+	const std::size_t first=count==samples.size() ? next : 0;
+	for(std::size_t i=0; i<count; i++) {
+
+		result.push_back(samples[(first+i) % samples.size()]);
+	}
+
+	return result;
+}
+
+void frame_stats::write_csv(
+	std::ostream& _stream
+) const {
+
+	const auto window=get_samples();
+	const std::uint64_t first=total_frames-window.size();
+
+	_stream<<"frame,seconds\n";
+	for(std::size_t i=0; i<window.size(); i++) {
+
+		_stream<<first+i<<","<<window[i]<<"\n";
+	}
+}
+
+void frame_stats::write_binary(
+	std::ostream& _stream
+) const {
+
+	const auto window=get_samples();
+	const std::uint32_t version=1,
+		frames=window.size();
+	const float budget_value=budget;
+
+	_stream.write("LDFS", 4);
+	_stream.write(reinterpret_cast<const char *>(&version), sizeof(version));
+	_stream.write(reinterpret_cast<const char *>(&frames), sizeof(frames));
+	_stream.write(reinterpret_cast<const char *>(&budget_value), sizeof(budget_value));
+	_stream.write(reinterpret_cast<const char *>(window.data()), window.size() * sizeof(float));
+}
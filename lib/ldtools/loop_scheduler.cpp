@@ -0,0 +1,132 @@
+#include <ldtools/loop_scheduler.h>
+
+#include <cmath>
+#include <stdexcept>
+
+using namespace ldtools;
+
+loop_scheduler::loop_scheduler(
+	tdelta _step,
+	std::size_t _max_steps,
+	tdelta _frame_time
+)
+	:step(_step),
+	frame_time(0.),
+	max_steps(_max_steps),
+	last_frame(clock().now()),
+	deadline(last_frame),
+	frames(600, _step),
+	updates(600, _step) {
+
+	if(!(_step > 0.) || !std::isfinite(_step)) {
+
+		throw std::runtime_error("loop_scheduler step must be positive");
+	}
+
+	set_max_steps(_max_steps);
+	set_frame_time(_frame_time);
+}
+
+loop_scheduler::loop_scheduler(
+	time_source& _source,
+	tdelta _step,
+	std::size_t _max_steps,
+	tdelta _frame_time
+)
+	:step(_step),
+	frame_time(0.),
+	max_steps(_max_steps),
+	source(&_source),
+	last_frame(clock().now()),
+	deadline(last_frame),
+	frames(600, _step),
+	updates(600, _step) {
+
+	if(!(_step > 0.) || !std::isfinite(_step)) {
+
+		throw std::runtime_error("loop_scheduler step must be positive");
+	}
+
+	set_max_steps(_max_steps);
+	set_frame_time(_frame_time);
+}
+
+std::size_t loop_scheduler::advance(
+	tdelta _elapsed
+) {
+
+	//Negative, infinite and NaN times would poison the accumulator for good.
+	if(!(std::isfinite(_elapsed) && _elapsed > 0.)) {
+
+		_elapsed=0.;
+	}
+
+	accumulator+=_elapsed;
+
+	const tdelta whole=std::floor(accumulator / step);
+	std::size_t due=max_steps;
+
+	if(whole > max_steps) {
+
+		//Only what fits in the maximum runs, the fraction is kept so the
+		//alpha does not jump.
+		dropped_time+=(whole-max_steps) * step;
+		++dropped_frames;
+		accumulator-=whole * step;
+	}
+	else {
+
+		due=whole;
+		accumulator-=due * step;
+	}
+
+	//Rounding could leave it a hair under 0 or at a whole step.
+	accumulator=std::min(std::max(accumulator, 0.), std::nextafter(step, 0.));
+	steps+=due;
+	return due;
+}
+
+void loop_scheduler::reset() {
+
+	accumulator=0.;
+	last_frame=deadline=clock().now();
+}
+
+void loop_scheduler::set_max_steps(
+	std::size_t _max_steps
+) {
+
+	if(!_max_steps) {
+
+		throw std::runtime_error("loop_scheduler must run at least one step per frame");
+	}
+
+	max_steps=_max_steps;
+}
+
+void loop_scheduler::set_frame_time(
+	tdelta _frame_time
+) {
+
+	frame_time=_frame_time > 0. ? _frame_time : 0.;
+	if(frame_time > 0.) {
+
+		frames.set_budget(frame_time);
+	}
+}
+
+void loop_scheduler::wait() {
+
+	auto& time=clock();
+	const auto frame_duration=std::chrono::duration_cast<time_source::duration>(std::chrono::duration<tdelta>(frame_time));
+
+	deadline+=frame_duration;
+	const auto now=time.now();
+	if(now > deadline+frame_duration) {
+
+		deadline=now;
+		return;
+	}
+
+	time.wait_until(deadline);
+}
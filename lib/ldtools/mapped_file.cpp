@@ -0,0 +1,88 @@
+#include <ldtools/mapped_file.h>
+
+#ifdef WINBUILD
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace ldtools;
+
+#ifdef WINBUILD
+
+mapped_file::mapped_file(const std::string& _path) {
+
+	std::ifstream file(_path, std::ios::binary | std::ios::ate);
+	if(!file) {
+
+		throw mapped_file_exception(std::string{"unable to open file "}+_path);
+	}
+
+	length=file.tellg();
+	if(!length) {
+
+		return;
+	}
+
+	buffer.resize(length);
+	file.seekg(0);
+	if(!file.read(buffer.data(), length)) {
+
+		throw mapped_file_exception(std::string{"unable to read file "}+_path);
+	}
+
+	begin=buffer.data();
+}
+
+mapped_file::~mapped_file() {
+
+}
+
+#else
+
+mapped_file::mapped_file(const std::string& _path) {
+
+	int fd=open(_path.c_str(), O_RDONLY);
+	if(-1==fd) {
+
+		throw mapped_file_exception(std::string{"unable to open file "}+_path);
+	}
+
+	struct stat info;
+	if(-1==fstat(fd, &info)) {
+
+		close(fd);
+		throw mapped_file_exception(std::string{"unable to stat file "}+_path);
+	}
+
+	length=info.st_size;
+	if(!length) {
+
+		close(fd);
+		return;
+	}
+
+	void * mem=mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if(MAP_FAILED==mem) {
+
+		length=0;
+		throw mapped_file_exception(std::string{"unable to map file "}+_path);
+	}
+
+	begin=static_cast<const char *>(mem);
+}
+
+mapped_file::~mapped_file() {
+
+	if(begin) {
+
+		munmap(const_cast<char *>(begin), length);
+	}
+}
+
+#endif
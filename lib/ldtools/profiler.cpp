@@ -0,0 +1,278 @@
+#include <ldtools/profiler.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+using namespace ldtools;
+
+namespace {
+
+struct zone {
+	const char *                name;
+	std::int64_t                begin,
+	                            end;
+};
+
+//!Zones are stored in linked chunks so that a reader can walk them while
+//!their thread keeps appending.
+struct chunk {
+	static const std::size_t    capacity=1024;
+
+	zone                        zones[capacity];
+	std::atomic<std::size_t>    count{0};
+	std::atomic<chunk *>        next{nullptr};
+};
+
+struct thread_buffer {
+
+	explicit                    thread_buffer(std::uint32_t _id)
+		:id(_id), name("thread "+std::to_string(_id)) {}
+
+	                            ~thread_buffer() {
+
+		release_chunks();
+	}
+
+	//!Deletes all chunks but the first.
+	void                        release_chunks() {
+
+		chunk * c=head.next.load(std::memory_order_relaxed);
+		while(c) {
+
+			chunk * next=c->next.load(std::memory_order_relaxed);
+			delete c;
+			c=next;
+		}
+
+		head.next.store(nullptr, std::memory_order_relaxed);
+		head.count.store(0, std::memory_order_relaxed);
+		tail=&head;
+	}
+
+	std::uint32_t               id;
+	std::string                 name;       //!< Guarded by the registry mutex.
+	chunk                       head;
+	chunk *                     tail{&head};    //!< Only used by the owner.
+	bool                        retired{false}; //!< Guarded by the registry mutex.
+};
+
+struct registry {
+
+	std::mutex                  mutex;
+	std::vector<std::unique_ptr<thread_buffer>> buffers;
+	std::atomic<bool>           enabled{true};
+	const std::chrono::steady_clock::time_point epoch{std::chrono::steady_clock::now()};
+};
+
+registry& get_registry() {
+
+	static registry instance;
+	return instance;
+}
+
+//!Gives the buffer back when the thread ends.
+struct thread_slot {
+
+	                            ~thread_slot() {
+
+		if(buffer) {
+
+			auto& r=get_registry();
+			std::lock_guard<std::mutex> lock(r.mutex);
+			buffer->retired=true;
+		}
+	}
+
+	thread_buffer *             buffer{nullptr};
+};
+
+thread_local thread_slot slot;
+
+thread_buffer& local_buffer() {
+
+	if(slot.buffer) {
+
+		return *slot.buffer;
+	}
+
+	auto& r=get_registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	for(auto& b : r.buffers) {
+
+		if(b->retired) {
+
+			b->retired=false;
+			slot.buffer=b.get();
+			return *slot.buffer;
+		}
+	}
+
+	r.buffers.push_back(std::make_unique<thread_buffer>(r.buffers.size()+1));
+	slot.buffer=r.buffers.back().get();
+	return *slot.buffer;
+}
+
+void write_escaped(
+	std::ostream& _stream,
+	const char * _text
+) {
+
+	const char * hex="0123456789abcdef";
+	for(; *_text; ++_text) {
+
+		const unsigned char c=*_text;
+		if('"'==c || '\\'==c) {
+
+			_stream<<'\\'<<(char)c;
+		}
+		else if(c < 0x20) {
+
+			_stream<<"\\u00"<<hex[c >> 4]<<hex[c & 15];
+		}
+		else {
+
+			_stream<<(char)c;
+		}
+	}
+}
+
+//!Writes nanoseconds as microseconds with three decimals.
+void write_microseconds(
+	std::ostream& _stream,
+	std::int64_t _nanoseconds
+) {
+
+	const std::int64_t remainder=_nanoseconds % 1000;
+	_stream<<_nanoseconds / 1000<<'.'
+		<<(char)('0'+remainder / 100)<<(char)('0'+remainder / 10 % 10)<<(char)('0'+remainder % 10);
+}
+}
+
+void profiler::set_enabled(
+	bool _enabled
+) {
+
+	get_registry().enabled.store(_enabled, std::memory_order_relaxed);
+}
+
+bool profiler::is_enabled() {
+
+	return get_registry().enabled.load(std::memory_order_relaxed);
+}
+
+std::int64_t profiler::now() {
+
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-get_registry().epoch).count();
+}
+
+void profiler::record(
+	const char * _name,
+	std::int64_t _begin,
+	std::int64_t _end
+) {
+
+	auto& buffer=local_buffer();
+	chunk * c=buffer.tail;
+	std::size_t count=c->count.load(std::memory_order_relaxed);
+
+	if(chunk::capacity==count) {
+
+		chunk * fresh=new chunk;
+		c->next.store(fresh, std::memory_order_release);
+		buffer.tail=c=fresh;
+		count=0;
+	}
+
+	c->zones[count]={_name, _begin, _end};
+	c->count.store(count+1, std::memory_order_release);
+}
+
+void profiler::set_thread_name(
+	const std::string& _name
+) {
+
+	auto& buffer=local_buffer();
+	std::lock_guard<std::mutex> lock(get_registry().mutex);
+	buffer.name=_name;
+}
+
+std::size_t profiler::get_zone_count() {
+
+	auto& r=get_registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+
+	std::size_t result=0;
+	for(const auto& b : r.buffers) {
+
+		for(const chunk * c=&b->head; c; c=c->next.load(std::memory_order_acquire)) {
+
+			result+=c->count.load(std::memory_order_acquire);
+		}
+	}
+
+	return result;
+}
+
+void profiler::write_chrome_trace(
+	std::ostream& _stream
+) {
+
+	auto& r=get_registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+
+	_stream<<"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	bool first=true;
+	auto separate=[&]() {
+
+		if(!first) {
+
+			_stream<<",";
+		}
+
+		_stream<<"\n";
+		first=false;
+	};
+
+	for(const auto& b : r.buffers) {
+
+		separate();
+		_stream<<"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"<<b->id<<",\"args\":{\"name\":\"";
+		write_escaped(_stream, b->name.c_str());
+		_stream<<"\"}}";
+
+		for(const chunk * c=&b->head; c; c=c->next.load(std::memory_order_acquire)) {
+
+			const std::size_t count=c->count.load(std::memory_order_acquire);
+			for(std::size_t i=0; i<count; i++) {
+
+				const auto& z=c->zones[i];
+				separate();
+				_stream<<"{\"name\":\"";
+				write_escaped(_stream, z.name);
+				_stream<<"\",\"cat\":\"ldtools\",\"ph\":\"X\",\"pid\":1,\"tid\":"<<b->id<<",\"ts\":";
+				write_microseconds(_stream, z.begin);
+				_stream<<",\"dur\":";
+				write_microseconds(_stream, z.end-z.begin);
+				_stream<<"}";
+			}
+		}
+	}
+
+	_stream<<"\n]}\n";
+}
+
+void profiler::clear() {
+
+	auto& r=get_registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+
+	for(auto& b : r.buffers) {
+
+		b->release_chunks();
+	}
+}
@@ -0,0 +1,105 @@
+#include <ldtools/sprite_quad_cache.h>
+
+#include <algorithm>
+#include <utility>
+
+using namespace ldtools;
+
+sprite_quad_cache::sprite_quad_cache() {
+
+}
+
+sprite_quad_cache::sprite_quad_cache(
+	const sprite_table& _table,
+	unsigned _texture_w,
+	unsigned _texture_h
+) {
+
+	build(_table, _texture_w, _texture_h);
+}
+
+void sprite_quad_cache::build(
+	const sprite_table& _table,
+	unsigned _texture_w,
+	unsigned _texture_h
+) {
+
+	if(!_texture_w || !_texture_h) {
+
+		throw sprite_table_exception("cannot build quads for an empty texture");
+	}
+
+	const std::size_t count=_table.size();
+	for(auto * v : {&uvs, &offsets_x, &offsets_y, &widths, &heights}) {
+
+		v->clear();
+	}
+
+	indexes.clear();
+	indexes.reserve(count);
+	uvs.reserve(count*8);
+	offsets_x.reserve(count);
+	offsets_y.reserve(count);
+	widths.reserve(count);
+	heights.reserve(count);
+
+	const float tw=_texture_w, th=_texture_h;
+
+	for(const auto& entry : _table) {
+
+		const auto& f=entry.second;
+		float u0=f.box.origin.x / tw,
+			v0=f.box.origin.y / th,
+			u1=(f.box.origin.x+f.box.w) / tw,
+			v1=(f.box.origin.y+f.box.h) / th;
+
+		if(f.is_flipped_horizontally()) {
+
+			std::swap(u0, u1);
+		}
+
+		if(f.is_flipped_vertically()) {
+
+			std::swap(v0, v1);
+		}
+
+		//Corners of the source in destination order, turned clockwise once
+		//per quarter of rotation.
+		const float corners[4][2]={{u0, v0}, {u1, v0}, {u1, v1}, {u0, v1}};
+		const int quarters=f.get_rotation() / 90;
+
+		for(int i=0; i<4; i++) {
+
+			const auto& corner=corners[(i+4-quarters) % 4];
+			uvs.push_back(corner[0]);
+			uvs.push_back(corner[1]);
+		}
+
+		const bool sideways=quarters % 2;
+		indexes.push_back(entry.first);
+		offsets_x.push_back(f.disp_x);
+		offsets_y.push_back(f.disp_y);
+		widths.push_back(sideways ? f.box.h : f.box.w);
+		heights.push_back(sideways ? f.box.w : f.box.h);
+	}
+}
+
+std::size_t sprite_quad_cache::slot(
+	std::size_t _index
+) const {
+
+	const auto it=std::lower_bound(std::begin(indexes), std::end(indexes), _index);
+	if(it==std::end(indexes) || *it!=_index) {
+
+		throw sprite_table_exception(std::string{"no quad for sprite index "}+std::to_string(_index));
+	}
+
+	return it-std::begin(indexes);
+}
+
+bool sprite_quad_cache::exists(
+	std::size_t _index
+) const {
+
+	return std::binary_search(std::begin(indexes), std::end(indexes), _index);
+}
@@ -1,7 +1,12 @@
 #include <ldtools/sprite_table.h>
+#include <ldtools/sprite_table_compiler.h>
+#include <ldtools/mapped_file.h>
+#include <ldtools/profiler.h>
 
-#include<fstream>
-#include<sstream>
+#include<algorithm>
+#include<charconv>
+#include<cstring>
+#include<type_traits>
 
 using namespace ldtools;
    
@@ -26,72 +31,602 @@ sprite_table::sprite_table() {
 
 }
 
+sprite_table::sprite_table(storage _storage) {
+
+	if(storage::compiled==_storage) {
+
+		throw sprite_table_exception("compiled storage is chosen by load_compiled");
+	}
+
+	text_storage=_storage;
+	current_storage=_storage;
+}
+
+sprite_table::sprite_table(
+	const container& _frames,
+	storage _storage
+)
+	:sprite_table(_storage) {
+
+	if(storage::map==_storage) {
+
+		data=_frames;
+		return;
+	}
+
+	std::vector<std::pair<size_t, sprite_frame>> entries{std::begin(_frames), std::end(_frames)};
+	store(entries);
+}
+
+sprite_table::sprite_table(
+	const embedded_sprite_table& _embedded,
+	storage _storage
+)
+	:sprite_table(_storage) {
+
+	std::vector<std::pair<size_t, sprite_frame>> entries;
+	entries.reserve(_embedded.count);
+
+	for(std::size_t i=0; i<_embedded.count; i++) {
+
+		const auto& e=_embedded.frames[i];
+		sprite_frame f{};
+		f.box.origin.x=e.x;
+		f.box.origin.y=e.y;
+		f.box.w=e.w;
+		f.box.h=e.h;
+		f.disp_x=e.disp_x;
+		f.disp_y=e.disp_y;
+		f.flags=e.flags;
+		entries.emplace_back(e.index, f);
+	}
+
+	if(storage::map==_storage) {
+
+		//Embedded frames are sorted, which makes the end a good hint.
+		for(const auto& entry : entries) {
+
+			data.emplace_hint(std::end(data), entry.first, entry.second);
+		}
+
+		return;
+	}
+
+	store(entries);
+}
+
+sprite_table& sprite_table::operator=(const sprite_table& _other) {
+
+	//Map entries have a const index, so the dense vector cannot be assigned.
+	return *this=sprite_table{_other};
+}
+
 sprite_table::sprite_table(const std::string& _path) {
 
 	load(_path);
 }
 
+sprite_table::sprite_table(
+	const std::string& _path,
+	storage _storage
+)
+	:sprite_table(_storage) {
+
+	load(_path);
+}
+
 bool sprite_table::exists(size_t _index) const {
 
-	return data.count(_index);
+	if(storage::map==current_storage) {
+
+		return data.count(_index);
+	}
+
+	return flat_position(_index)!=flat_count();
 }
 
 const sprite_frame& sprite_table::get(size_t _index) const {
 
-	if(!data.count(_index)) {
+	if(storage::map==current_storage) {
+
+		auto it=data.find(_index);
+		if(it!=data.end()) {
+
+			return it->second;
+		}
+	}
+	else {
+
+		auto pos=flat_position(_index);
+		if(pos!=flat_count()) {
+
+			return flat_entries()[pos].second;
+		}
+	}
+
+	throw sprite_table_exception(std::string{"cannot get invalid sprite index "}+std::to_string(_index));
+}
+
+size_t sprite_table::size() const {
+
+	return storage::map==current_storage
+		? data.size()
+		: flat_count();
+}
+
+sprite_table::iterator sprite_table::begin() {
+
+	if(storage::map==current_storage) {
+
+		return iterator{data.begin()};
+	}
+
+	return iterator{dense_mutable_entries()};
+}
+
+sprite_table::iterator sprite_table::end() {
+
+	if(storage::map==current_storage) {
+
+		return iterator{data.end()};
+	}
+
+	return iterator{dense_mutable_entries()+flat_count()};
+}
+
+sprite_table::const_iterator sprite_table::begin() const {
+
+	if(storage::map==current_storage) {
 
-		throw sprite_table_exception(std::string{"cannot get invalid sprite index "}+std::to_string(_index));
+		return const_iterator{data.begin()};
 	}
 
-	return data.at(_index);
+	return const_iterator{flat_entries()};
+}
+
+sprite_table::const_iterator sprite_table::end() const {
+
+	if(storage::map==current_storage) {
+
+		return const_iterator{data.end()};
+	}
+
+	return const_iterator{flat_entries()+flat_count()};
+}
+
+void sprite_table::reset() {
+
+	data.clear();
+	dense_entries.clear();
+	dense_directory.clear();
+	dense_blocks.clear();
+	compiled.reset();
+	compiled_count=0;
+	current_storage=text_storage;
 }
 
 sprite_table& sprite_table::load(const std::string& _path) {
 
-	std::ifstream input_file(_path);
+	LDTOOLS_PROFILE_ZONE("sprite_table::load");
+
+	//The whole file is read in one go and scanned in place.
+	std::unique_ptr<mapped_file> file;
+	try {
+		file=std::make_unique<mapped_file>(_path);
+	}
+	catch(mapped_file_exception&) {
 
-	if(!input_file){
 		throw sprite_table_exception(std::string{"Unable to locate sprite file "}+_path);
 	}
 
-	std::stringstream ss{};
-	std::string line;
-	while(true) {
+	if(text_storage!=current_storage) {
 
-		std::getline(input_file, line);
-		if(input_file.eof()) {
+		reset();
+	}
+
+	std::vector<std::pair<size_t, sprite_frame>> entries;
+	const char * cursor=file->data(),
+		* const file_end=cursor+file->size();
+
+	while(cursor!=file_end) {
+
+		const char * line=cursor,
+			* line_end=static_cast<const char *>(std::memchr(cursor, '\n', file_end-cursor));
+
+		//A last line without a newline is ignored, as std::getline used to.
+		if(!line_end) {
 			break;
 		}
 
-		if(!line.size()) {
+		cursor=line_end+1;
+
+		if(line==line_end) {
 			continue;
 		}
 
-		if('#'==line[0]) {
+		if('#'==*line) {
 			continue;
 		}
 
-		ss.clear();
-		ss.str(line);
-
 		sprite_frame f{};
 		size_t index;
-		ss>>index>>f.box.origin.x>>f.box.origin.y>>f.box.w>>f.box.h>>f.disp_x>>f.disp_y;
+		if(!parse_line(line, line_end, index, f)) {
 
-		if(ss.fail()) {
+			reset();
+			throw sprite_table_exception(std::string{"Malformed sprite line in "}+_path+" : "+std::string{line, line_end});
+		}
 
-			data.clear();
-			throw sprite_table_exception(std::string{"Malformed sprite line in "}+_path+" : "+line);
+		if(storage::map==current_storage) {
+
+			//Files are usually sorted, which makes the end a good hint.
+			data.emplace_hint(std::end(data), index, f);
+		}
+		else {
+
+			entries.emplace_back(index, f);
 		}
+	}
 
-		ss>>f.flags;
-		if(ss.fail()) {
+	if(storage::map==current_storage) {
 
-			//no sweat, older file format.
+		return *this;
+	}
+
+	try {
+		store(entries);
+	}
+	catch(sprite_table_exception& e) {
+
+		reset();
+		throw sprite_table_exception(e.what()+std::string{" in "}+_path);
+	}
+
+	return *this;
+}
+
+std::vector<size_t> sprite_table::reload(
+	const std::string& _path,
+	const reload_check& _check
+) {
+
+	sprite_table fresh{text_storage};
+	if(storage::compiled==current_storage) {
+
+		fresh.load_compiled(_path);
+	}
+	else {
+
+		fresh.load(_path);
+	}
+
+	//Both tables are walked in index order.
+	std::vector<size_t> changed;
+	bool same_indexes=true;
+	auto old_it=std::cbegin(*this), new_it=std::cbegin(fresh);
+	const auto old_end=std::cend(*this), new_end=std::cend(fresh);
+
+	while(old_it!=old_end || new_it!=new_end) {
+
+		if(new_it==new_end || (old_it!=old_end && old_it->first < new_it->first)) {
+
+			changed.push_back(old_it->first);
+			same_indexes=false;
+			++old_it;
 		}
+		else if(old_it==old_end || new_it->first < old_it->first) {
+
+			changed.push_back(new_it->first);
+			same_indexes=false;
+			++new_it;
+		}
+		else {
+
+			if(old_it->second!=new_it->second) {
+
+				changed.push_back(old_it->first);
+			}
+
+			++old_it;
+			++new_it;
+		}
+	}
+
+	if(_check) {
+
+		_check(fresh, changed);
+	}
+
+	if(storage::map==current_storage) {
+
+		for(auto index : changed) {
+
+			auto it=fresh.data.find(index);
+			if(it==fresh.data.end()) {
+
+				data.erase(index);
+			}
+			else {
+
+				data[index]=it->second;
+			}
+		}
+	}
+	else if(storage::dense==current_storage && same_indexes) {
+
+		for(auto index : changed) {
+
+			dense_entries[flat_position(index)].second=fresh.get(index);
+		}
+	}
+	else {
+
+		*this=std::move(fresh);
+	}
+
+	return changed;
+}
+
+bool sprite_table::parse_line(
+	const char * _cursor,
+	const char * _end,
+	size_t& _index,
+	sprite_frame& _frame
+) {
+
+	if(!read_value(_cursor, _end, _index)
+		|| !read_value(_cursor, _end, _frame.box.origin.x)
+		|| !read_value(_cursor, _end, _frame.box.origin.y)
+		|| !read_value(_cursor, _end, _frame.box.w)
+		|| !read_value(_cursor, _end, _frame.box.h)
+		|| !read_value(_cursor, _end, _frame.disp_x)
+		|| !read_value(_cursor, _end, _frame.disp_y)
+	) {
+
+		return false;
+	}
+
+	if(!read_value(_cursor, _end, _frame.flags)) {
+
+		//no sweat, older file format.
+		_frame.flags=0;
+	}
+
+	return true;
+}
+
+template<typename T>
+bool sprite_table::read_value(
+	const char *& _cursor,
+	const char * _end,
+	T& _value
+) {
+
+	//Same whitespace that operator>> skips in the classic locale, without
+	//the newline, which never reaches this point.
+	auto is_space=[](char _c) {
+
+		return ' '==_c || '\t'==_c || '\r'==_c || '\v'==_c || '\f'==_c;
+	};
+
+	while(_cursor!=_end && is_space(*_cursor)) {
+		++_cursor;
+	}
+
+	if(_cursor!=_end && '+'==*_cursor) {
+		++_cursor;
+	}
+
+	const auto result=std::from_chars(_cursor, _end, _value);
+	if(std::errc{}!=result.ec) {
+
+		return false;
+	}
+
+	_cursor=result.ptr;
+	return true;
+}
+
+void sprite_table::store(
+	std::vector<std::pair<size_t, sprite_frame>>& _entries
+) {
+
+	if(storage::map==current_storage) {
+
+		data.insert(std::begin(_entries), std::end(_entries));
+		return;
+	}
+
+	//Existing frames go first so they win when removing duplicates, as the
+	//map would do.
+	std::vector<std::pair<size_t, sprite_frame>> entries;
+	entries.reserve(dense_entries.size()+_entries.size());
+	entries.insert(std::end(entries), std::begin(dense_entries), std::end(dense_entries));
+
+	for(const auto& entry : _entries) {
+
+		if(entry.first >= dense_none) {
+
+			throw sprite_table_exception(std::string{"sprite index "}+std::to_string(entry.first)+" is too large for dense storage");
+		}
+
+		entries.push_back(entry);
+	}
+
+	auto by_index=[](const std::pair<size_t, sprite_frame>& _a, const std::pair<size_t, sprite_frame>& _b) {
+
+		return _a.first < _b.first;
+	};
+
+	auto same_index=[](const std::pair<size_t, sprite_frame>& _a, const std::pair<size_t, sprite_frame>& _b) {
+
+		return _a.first == _b.first;
+	};
+
+	if(!std::is_sorted(std::begin(entries), std::end(entries), by_index)) {
+
+		std::stable_sort(std::begin(entries), std::end(entries), by_index);
+	}
+
+	entries.erase(std::unique(std::begin(entries), std::end(entries), same_index), std::end(entries));
+
+	dense_entries.clear();
+	dense_directory.clear();
+	dense_blocks.clear();
+
+	dense_entries.reserve(entries.size());
+
+	for(const auto& entry : entries) {
+
+		const size_t page=entry.first / dense_page_size;
+		if(page >= dense_directory.size()) {
+
+			dense_directory.resize(page+1, dense_none);
+		}
+
+		if(dense_none==dense_directory[page]) {
+
+			dense_directory[page]=dense_blocks.size() / dense_page_size;
+			dense_blocks.resize(dense_blocks.size()+dense_page_size, dense_none);
+		}
+
+		dense_blocks[dense_directory[page]*dense_page_size + entry.first % dense_page_size]=dense_entries.size();
+		dense_entries.emplace_back(entry.first, entry.second);
+	}
+
+	dense_entries.shrink_to_fit();
+	dense_directory.shrink_to_fit();
+	dense_blocks.shrink_to_fit();
+}
+
+size_t sprite_table::flat_position(size_t _index) const {
+
+	if(storage::dense==current_storage) {
+
+		const size_t page=_index / dense_page_size;
+		if(page >= dense_directory.size() || dense_none==dense_directory[page]) {
+
+			return flat_count();
+		}
+
+		const auto pos=dense_blocks[dense_directory[page]*dense_page_size + _index % dense_page_size];
+		return dense_none==pos
+			? flat_count()
+			: pos;
+	}
+
+	const auto * entries=flat_entries();
+	const auto * it=std::lower_bound(
+		entries,
+		entries+compiled_count,
+		_index,
+		[](const container::value_type& _entry, size_t _value) {
+			return _entry.first < _value;
+		}
+	);
+
+	return it!=entries+compiled_count && it->first==_index
+		? it-entries
+		: compiled_count;
+}
+
+size_t sprite_table::flat_count() const {
+
+	return storage::dense==current_storage
+		? dense_entries.size()
+		: compiled_count;
+}
+
+const sprite_table::container::value_type * sprite_table::flat_entries() const {
+
+	if(storage::dense==current_storage) {
+
+		return dense_entries.data();
+	}
+
+	const auto * header=reinterpret_cast<const compiled_sprite_table_header *>(compiled->data());
+	return reinterpret_cast<const container::value_type *>(compiled->data()+header->entries_offset);
+}
+
+sprite_table::container::value_type * sprite_table::dense_mutable_entries() {
+
+	if(storage::dense!=current_storage) {
+
+		throw sprite_table_exception("compiled sprite tables are read only, iterate them as const");
+	}
+
+	return dense_entries.data();
+}
+
+sprite_table& sprite_table::load_compiled(const std::string& _path) {
+
+	LDTOOLS_PROFILE_ZONE("sprite_table::load_compiled");
+
+	static_assert(std::is_trivially_copyable<container::value_type>::value, "compiled sprite tables need trivially copyable entries");
+
+	reset();
+
+	std::shared_ptr<mapped_file> file;
+	try {
+		file=std::make_shared<mapped_file>(_path);
+	}
+	catch(mapped_file_exception&) {
+
+		throw sprite_table_exception(std::string{"Unable to locate compiled sprite file "}+_path);
+	}
+
+	auto fail=[&_path](const std::string& _reason) {
+
+		throw sprite_table_exception(std::string{"Invalid compiled sprite file "}+_path+" : "+_reason);
+	};
+
+	using header_type=compiled_sprite_table_header;
+	header_type header;
+	if(file->size() < sizeof(header_type)) {
+
+		fail("too short");
+	}
+
+	std::memcpy(&header, file->data(), sizeof(header_type));
+
+	if(header_type::magic_value!=header.magic) {
+
+		fail("not a compiled sprite table");
+	}
+
+	if(header_type::version_value!=header.version) {
+
+		fail("unsupported version");
+	}
+
+	if(header_type::endianness_value!=header.endianness
+		|| sizeof(container::value_type)!=header.entry_size
+	) {
+
+		fail("compiled for a different platform");
+	}
+
+	if(header.entries_offset % alignof(container::value_type)
+		|| header.entries_offset > file->size()
+		|| header.count > (file->size()-header.entries_offset) / sizeof(container::value_type)
+	) {
+
+		fail("bad offsets");
+	}
+
+	//Lookups are binary searches: indexes must be sorted and unique.
+	const auto * entries=reinterpret_cast<const container::value_type *>(file->data()+header.entries_offset);
+	auto unsorted=[](const container::value_type& _a, const container::value_type& _b) {
+
+		return _a.first >= _b.first;
+	};
+
+	if(std::adjacent_find(entries, entries+header.count, unsorted)!=entries+header.count) {
 
-		data.insert(std::make_pair(index, f));
+		fail("unsorted indexes");
 	}
 
+	compiled=file;
+	compiled_count=header.count;
+	current_storage=storage::compiled;
 	return *this;
 }
@@ -0,0 +1,58 @@
+#include <ldtools/sprite_table_compiler.h>
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using namespace ldtools;
+
+void ldtools::compile_sprite_table(
+	const sprite_table& _table,
+	const std::string& _path
+) {
+
+	using header_type=compiled_sprite_table_header;
+
+	auto align=[](std::uint64_t _offset, std::uint64_t _alignment) {
+
+		return (_offset + _alignment - 1) / _alignment * _alignment;
+	};
+
+	using entry_type=sprite_table::container::value_type;
+
+	header_type header{};
+	header.magic=header_type::magic_value;
+	header.version=header_type::version_value;
+	header.endianness=header_type::endianness_value;
+	header.entry_size=sizeof(entry_type);
+	header.count=_table.size();
+	header.entries_offset=align(sizeof(header_type), alignof(entry_type));
+
+	std::vector<char> buffer(header.entries_offset+header.count*sizeof(entry_type), 0);
+	std::memcpy(buffer.data(), &header, sizeof(header_type));
+
+	//Tables are always iterated in index order, as the format requires. The
+	//members are copied one by one so the padding stays zero.
+	char * out=buffer.data()+header.entries_offset;
+	for(const auto& entry : _table) {
+
+		const auto frame_offset=reinterpret_cast<const char *>(&entry.second)-reinterpret_cast<const char *>(&entry);
+		std::memcpy(out, &entry.first, sizeof(entry.first));
+		std::memcpy(out+frame_offset, &entry.second, sizeof(entry.second));
+		out+=sizeof(entry_type);
+	}
+
+	std::ofstream file(_path, std::ios::binary | std::ios::trunc);
+	if(!file.write(buffer.data(), buffer.size())) {
+
+		throw sprite_table_exception(std::string{"unable to write compiled sprite file "}+_path);
+	}
+}
+
+void ldtools::compile_sprite_table(
+	const std::string& _source,
+	const std::string& _path
+) {
+
+	compile_sprite_table(sprite_table{_source}, _path);
+}
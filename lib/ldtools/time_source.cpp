@@ -0,0 +1,53 @@
+#include <ldtools/time_source.h>
+#include <ldtools/timing_replay.h>
+
+using namespace ldtools;
+
+void manual_time_source::wait_until(
+	time_point _time
+) {
+
+	if(_time > current) {
+
+		current=_time;
+	}
+}
+
+void manual_time_source::advance(
+	tdelta _seconds
+) {
+
+	current+=std::chrono::duration_cast<duration>(std::chrono::duration<tdelta>(_seconds));
+}
+
+recorded_time_source::recorded_time_source(
+	const std::vector<tdelta>& _deltas
+)
+	:deltas(_deltas) {
+
+}
+
+recorded_time_source::recorded_time_source(
+	const std::string& _path
+)
+	:deltas(timing_recorder::load(_path)) {
+
+}
+
+bool recorded_time_source::next_frame() {
+
+	if(frame==deltas.size()) {
+
+		return false;
+	}
+
+	current+=std::chrono::duration_cast<duration>(std::chrono::duration<tdelta>(deltas[frame]));
+	++frame;
+	return true;
+}
+
+void recorded_time_source::rewind() {
+
+	frame=0;
+	current=time_point{};
+}
@@ -0,0 +1,133 @@
+#include <ldtools/timing_replay.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <time.h>
+#endif
+
+using namespace ldtools;
+
+timing_recorder::timing_recorder(
+	time_source& _source
+)
+	:source(_source),
+	last(_source.now()) {
+
+}
+
+void timing_recorder::frame() {
+
+	const auto now=source.now();
+	deltas.push_back(std::chrono::duration<tdelta>(now-last).count());
+	last=now;
+}
+
+void timing_recorder::save(
+	const std::string& _path
+) const {
+
+	std::ofstream file(_path);
+	if(!file) {
+
+		throw std::runtime_error("unable to write timing recording "+_path);
+	}
+
+	file<<std::hexfloat;
+	for(auto delta : deltas) {
+
+		file<<delta<<"\n";
+	}
+
+	if(!file) {
+
+		throw std::runtime_error("unable to write timing recording "+_path);
+	}
+}
+
+std::vector<tdelta> timing_recorder::load(
+	const std::string& _path
+) {
+
+	std::ifstream file(_path);
+	if(!file) {
+
+		throw std::runtime_error("unable to read timing recording "+_path);
+	}
+
+	//Streams do not read hexadecimal floating point reliably, strtod does.
+	std::vector<tdelta> result;
+	std::string line;
+	std::size_t line_number=0;
+	while(std::getline(file, line)) {
+
+		++line_number;
+		if(line.empty()) {
+
+			continue;
+		}
+
+		char * end=nullptr;
+		errno=0;
+		const tdelta value=std::strtod(line.c_str(), &end);
+		if(end==line.c_str() || 0!=errno || !std::all_of((const char *)end, line.c_str()+line.size(), [](char _c) {return ' '==_c || '\t'==_c || '\r'==_c;})) {
+
+			throw std::runtime_error("bad timing recording "+_path+" : line "+std::to_string(line_number));
+		}
+
+		result.push_back(value);
+	}
+
+	return result;
+}
+
+timing_replay::timing_replay(
+	recorded_time_source& _source
+)
+	:source(_source) {
+
+}
+
+frame_stats timing_replay::get_cost_stats() const {
+
+	frame_stats result{std::max<std::size_t>(1, costs.size())};
+	for(auto cost : costs) {
+
+		result.add(cost / 1e9);
+	}
+
+	return result;
+}
+
+void timing_replay::write_csv(
+	std::ostream& _stream
+) const {
+
+	const auto& deltas=source.get_deltas();
+
+	_stream<<"frame,seconds,cpu_ns\n";
+	for(std::size_t i=0; i<costs.size(); i++) {
+
+		_stream<<i<<","<<deltas[i]<<","<<costs[i]<<"\n";
+	}
+}
+
+std::int64_t timing_replay::cpu_now() {
+
+#ifdef __linux__
+
+	timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (std::int64_t)ts.tv_sec * 1000000000+ts.tv_nsec;
+
+#else
+
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+#endif
+}
@@ -1,48 +1,347 @@
 #include <ldtools/ttf_manager.h>
+#include <ldtools/profiler.h>
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 using namespace ldtools;
 
+ttf_manager::font_ref::font_ref(const font_entry& _entry)
+	:entry(&_entry) {
+
+	++entry->refs;
+}
+
+ttf_manager::font_ref::font_ref(const font_ref& _other)
+	:entry(_other.entry) {
+
+	if(entry) {
+		++entry->refs;
+	}
+}
+
+ttf_manager::font_ref::font_ref(font_ref&& _other) noexcept
+	:entry(_other.entry) {
+
+	_other.entry=nullptr;
+}
+
+ttf_manager::font_ref::~font_ref() {
+
+	if(entry) {
+		--entry->refs;
+	}
+}
+
+ttf_manager::font_ref& ttf_manager::font_ref::operator=(font_ref _other) {
+
+	std::swap(entry, _other.entry);
+	return *this;
+}
+
 const ldv::ttf_font& ttf_manager::get(const std::string& f, int t) const {
 
-	if(!exists(f, t)) {
+	auto it=data.find({f,t});
+	if(it==std::end(data)) {
 		throw std::runtime_error("TTF font "+f+" was not registered in the requested size");
 	}
 
-	return data.at({f,t});
+	return use(it->second);
+}
+
+const ldv::ttf_font& ttf_manager::get(handle _handle) const {
+
+	return use(entry_for(_handle));
+}
+
+const ldv::ttf_font& ttf_manager::use(const font_entry& _entry) const {
+
+	if(budget) {
+
+		_entry.last_use=++use_clock;
+	}
+
+	if(!_entry.ready) {
+
+		open(_entry);
+	}
+
+	return *_entry.font;
+}
+
+ttf_manager::font_ref ttf_manager::acquire(const std::string& f, int t) const {
+
+	return acquire(get_handle(f, t));
+}
+
+ttf_manager::font_ref ttf_manager::acquire(handle _handle) const {
+
+	const auto& entry=entry_for(_handle);
+	use(entry);
+	return font_ref{entry};
+}
+
+ttf_manager::font_entry& ttf_manager::entry_for(handle _handle) const {
+
+	if(!exists(_handle)) {
+		throw std::runtime_error("invalid TTF font handle "+std::to_string(_handle));
+	}
+
+	return *handles[_handle];
+}
+
+ttf_manager::handle ttf_manager::get_handle(const std::string& f, int t) const {
+
+	auto it=data.find({f,t});
+	if(it==std::end(data)) {
+		throw std::runtime_error("TTF font "+f+" was not registered in the requested size");
+	}
+
+	return it->second.id;
 }
 
 bool ttf_manager::insert(const std::string& f, int t, const std::string& r)
 {
+	LDTOOLS_PROFILE_ZONE("ttf_manager::insert");
+
 	if(!exists(f, t)) {
 
-		data.emplace(
-			std::piecewise_construct,
-			std::forward_as_tuple(font_info{f, t}),
-			std::forward_as_tuple(ldv::ttf_font(r, t))
-		);
+		auto& entry=add(f, t, r);
+
+		try {
+			open(entry);
+		}
+		catch(...) {
+			handles[entry.id]=nullptr;
+			data.erase({f, t});
+			throw;
+		}
+
 		return true;
 	}
 
 	return true;
 }
 
+bool ttf_manager::insert_lazy(const std::string& f, int t, const std::string& r)
+{
+	if(exists(f, t)) {
+
+		return false;
+	}
+
+	add(f, t, r);
+	return true;
+}
+
+ttf_manager::font_entry& ttf_manager::add(const std::string& f, int t, const std::string& r)
+{
+	auto& entry=data[{f, t}];
+	entry.path=&*paths.insert(r).first;
+	entry.size=t;
+	entry.id=handles.size();
+	handles.push_back(&entry);
+	return entry;
+}
+
 bool ttf_manager::exists(const std::string& _fontname, int _fontsize) const {
 
 	return data.count({_fontname, _fontsize});
 }
 
+bool ttf_manager::is_ready(const std::string& _fontname, int _fontsize) const {
+
+	auto it=data.find({_fontname, _fontsize});
+	return it!=std::end(data) && it->second.ready;
+}
+
+bool ttf_manager::is_ready() const {
+
+	for(const auto& pair : data) {
+
+		if(!pair.second.ready) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::size_t ttf_manager::loaded_size() const {
+
+	std::size_t result=0;
+	for(const auto& pair : data) {
+
+		result+=pair.second.ready;
+	}
+
+	return result;
+}
+
+bool ttf_manager::warm_up_step(tdelta _time) {
+
+	LDTOOLS_PROFILE_ZONE("ttf_manager::warm_up_step");
+
+	using clock=std::chrono::steady_clock;
+	const auto start=clock::now();
+	bool opened_any=false;
+
+	for(auto& pair : data) {
+
+		auto& entry=pair.second;
+		if(entry.ready || entry.failed) {
+			continue;
+		}
+
+		//Closing fonts here could pull them from under a get.
+		if(budget && footprint >= budget) {
+			return false;
+		}
+
+		if(opened_any && std::chrono::duration<tdelta>(clock::now()-start).count() >= _time) {
+			return true;
+		}
+
+		try {
+			open(entry, false);
+		}
+		catch(std::exception&) {
+			//get will try again and report it.
+			entry.failed=true;
+		}
+
+		opened_any=true;
+	}
+
+	return false;
+}
+
 void ttf_manager::erase(const std::string& _fontname, int _fontsize) {
 
 	if(!exists(_fontname, _fontsize)) {
 		throw std::runtime_error("ttf font "+_fontname+" could not be erased");
 	}
 
-	data.erase({_fontname, _fontsize});
+	auto it=data.find({_fontname, _fontsize});
+	if(it->second.refs) {
+		throw std::runtime_error("ttf font "+_fontname+" is still referenced and could not be erased");
+	}
+
+	if(it->second.ready) {
+		footprint-=it->second.bytes;
+	}
+
+	handles[it->second.id]=nullptr;
+	data.erase(it);
 }
 
 void ttf_manager::clear() {
 
+	for(const auto& pair : data) {
+
+		if(pair.second.refs) {
+			throw std::runtime_error("ttf font "+pair.first.name+" is still referenced, the manager could not be cleared");
+		}
+	}
+
 	data.clear();
+	paths.clear();
+	footprint=0;
+
+	//Handles are not reused, so old ones stay invalid.
+	std::fill(std::begin(handles), std::end(handles), nullptr);
+}
+
+void ttf_manager::set_budget(std::size_t _budget) {
+
+	budget=_budget;
+
+	trim(nullptr);
+}
+
+void ttf_manager::set_pinned(handle _handle, bool _pinned) {
+
+	entry_for(_handle).pinned=_pinned;
+}
+
+bool ttf_manager::is_pinned(handle _handle) const {
+
+	const auto& entry=entry_for(_handle);
+	return entry.pinned || entry.refs;
+}
+
+ttf_manager_stats ttf_manager::get_stats() const {
+
+	ttf_manager_stats result;
+	result.footprint=footprint;
+	result.open=loaded_size();
+	result.evictions=evictions;
+	result.reloads=reloads;
+	return result;
+}
+
+void ttf_manager::open(const font_entry& _entry, bool _may_evict) const {
+
+	LDTOOLS_PROFILE_ZONE("ttf_manager::open");
+
+	if(_entry.ready) {
+
+		return;
+	}
+
+	_entry.font=std::make_unique<ldv::ttf_font>(*_entry.path, _entry.size);
+
+	//The file size stands for what the font takes.
+	std::ifstream file(*_entry.path, std::ios::binary | std::ios::ate);
+	const auto size=file ? (std::streamoff)file.tellg() : 0;
+	_entry.bytes=size > 0 ? size : 0;
+	footprint+=_entry.bytes;
+
+	if(_entry.evicted) {
+
+		_entry.evicted=false;
+		++reloads;
+	}
+
+	_entry.last_use=++use_clock;
+	_entry.ready=true;
+
+	if(_may_evict) {
+
+		trim(&_entry);
+	}
+}
+
+void ttf_manager::trim(const font_entry * _keep) const {
+
+	while(budget && footprint > budget) {
+
+		const font_entry * oldest=nullptr;
+		for(const auto& pair : data) {
+
+			const auto& entry=pair.second;
+			if(&entry==_keep || entry.pinned || entry.refs || !entry.ready) {
+				continue;
+			}
+
+			if(!oldest || entry.last_use < oldest->last_use) {
+				oldest=&entry;
+			}
+		}
+
+		if(!oldest) {
+
+			return;
+		}
+
+		oldest->ready=false;
+		oldest->font.reset();
+		oldest->evicted=true;
+		footprint-=oldest->bytes;
+		++evictions;
+	}
 }
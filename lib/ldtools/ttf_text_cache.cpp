@@ -0,0 +1,119 @@
+#include <ldtools/ttf_text_cache.h>
+
+#include <functional>
+#include <utility>
+
+using namespace ldtools;
+
+bool ttf_text_cache::key::operator==(
+	const key& _other
+) const {
+
+	return size==_other.size
+		&& r==_other.r && g==_other.g && b==_other.b && a==_other.a
+		&& ratio==_other.ratio
+		&& alias==_other.alias
+		&& text==_other.text;
+}
+
+std::size_t ttf_text_cache::key_hash::operator()(
+	const key& _key
+) const {
+
+	std::size_t result=std::hash<std::string>{}(_key.text);
+	auto combine=[&result](std::size_t _value) {
+
+		result^=_value+0x9e3779b97f4a7c15ull+(result << 6)+(result >> 2);
+	};
+
+	combine(std::hash<std::string>{}(_key.alias));
+	combine(std::hash<int>{}(_key.size));
+	combine(std::hash<float>{}(_key.r));
+	combine(std::hash<float>{}(_key.g));
+	combine(std::hash<float>{}(_key.b));
+	combine(std::hash<float>{}(_key.a));
+	combine(std::hash<double>{}(_key.ratio));
+	return result;
+}
+
+ttf_text_cache::held_text::held_text(
+	ttf_manager::font_ref _font,
+	const ldv::rgba_color& _color,
+	const std::string& _text,
+	double _ratio
+)
+	:font(std::move(_font)), text(*font, _color, _text, _ratio) {
+
+}
+
+ttf_text_cache::ttf_text_cache(
+	const ttf_manager& _fonts,
+	std::size_t _budget
+)
+	:fonts(_fonts), budget(_budget) {
+
+}
+
+std::shared_ptr<ldv::ttf_representation> ttf_text_cache::get(
+	const std::string& _alias,
+	int _size,
+	const std::string& _text,
+	const ldv::rgba_color& _color,
+	double _ratio
+) {
+
+	key id{_alias, _size, _text, _color.r, _color.g, _color.b, _color.a, _ratio};
+
+	auto it=index.find(id);
+	if(it!=std::end(index)) {
+
+		++stats.hits;
+		entries.splice(std::begin(entries), entries, it->second);
+		return it->second->text;
+	}
+
+	++stats.misses;
+
+	//The text shares ownership with its holder, which keeps the font open.
+	auto holder=std::make_shared<held_text>(fonts.acquire(_alias, _size), _color, _text, _ratio);
+	std::shared_ptr<ldv::ttf_representation> text{holder, &holder->text};
+	text->set_blend(ldv::representation::blends::alpha);
+
+	const auto box=text->get_view_position();
+	const std::size_t text_bytes=(std::size_t)box.w * box.h * 4;
+
+	entries.push_front({id, text, text_bytes});
+	index.emplace(std::move(id), std::begin(entries));
+	bytes+=text_bytes;
+
+	//The newest text stays even if it alone goes over the budget.
+	trim();
+	return text;
+}
+
+void ttf_text_cache::set_budget(
+	std::size_t _budget
+) {
+
+	budget=_budget;
+	trim();
+}
+
+void ttf_text_cache::clear() {
+
+	index.clear();
+	entries.clear();
+	bytes=0;
+}
+
+void ttf_text_cache::trim() {
+
+	while(bytes > budget && entries.size() > 1) {
+
+		auto& last=entries.back();
+		bytes-=last.bytes;
+		index.erase(last.id);
+		entries.pop_back();
+		++stats.evictions;
+	}
+}
@@ -1,4 +1,5 @@
 #include <ldtools/view_composer.h>
+#include <ldtools/profiler.h>
 
 #include <tools/json.h>
 
@@ -7,7 +8,14 @@
 #include <ldv/ttf_representation.h>
 #include <ldv/polygon_representation.h>
 
+#include <rapidjson/reader.h>
+#include <rapidjson/filereadstream.h>
+#include <rapidjson/memorystream.h>
+#include <rapidjson/error/en.h>
+
 #include <algorithm>
+#include <cstdio>
+#include <utility>
 
 using namespace ldtools;
 
@@ -51,6 +59,8 @@ view_composer::view_composer()
 
 void view_composer::draw(ldv::screen& p) {
 
+	LDTOOLS_PROFILE_ZONE("view_composer::draw");
+
 	if(with_screen)	{
 		p.clear(screen_color);
 	}
@@ -63,6 +73,9 @@ void view_composer::draw(ldv::screen& p) {
 //!Draws the composition to the screen using a camera.
 
 void view_composer::draw(ldv::screen& p, const ldv::camera& cam) {
+
+	LDTOOLS_PROFILE_ZONE("view_composer::draw");
+
 	if(with_screen)	{
 		p.clear(screen_color);
 	}
@@ -77,6 +90,8 @@ void view_composer::draw(
 	ldv::point _origin
 ) {
 
+	LDTOOLS_PROFILE_ZONE("view_composer::draw");
+
 	if(with_screen)	{
 
 		p.clear(screen_color);
@@ -98,6 +113,9 @@ void view_composer::draw(
 	const ldv::camera& cam,
 	ldv::point _origin
 ) {
+
+	LDTOOLS_PROFILE_ZONE("view_composer::draw");
+
 	if(with_screen)	{
 		p.clear(screen_color);
 	}
@@ -168,6 +186,13 @@ void view_composer::map_font(const std::string& clave, const ldv::ttf_font& fuen
 	map_font(clave, &fuente);
 }
 
+//!Same as map textures, but with fonts of a ttf_manager, which are kept open.
+
+void view_composer::map_font(const std::string& clave, ttf_manager::font_ref fuente) {
+	map_font(clave, &*fuente);
+	font_refs.push_back(std::move(fuente));
+}
+
 //!Returns the representation with the given id.
 
 //!Will throw if there is no representation with that id. The representation
@@ -195,98 +220,550 @@ bool view_composer::id_exists(const std::string& id) const {
 	return id_map.count(id);
 }
 
+namespace {
+
+//!Fills the integers from a json list with at least as many. Internal.
+bool ints_from_list(
+	const rapidjson::Value& _value,
+	int * _out,
+	rapidjson::SizeType _count
+) {
+
+	if(!_value.IsArray() || _value.Size() < _count) {
+
+		return false;
+	}
+
+	for(rapidjson::SizeType i=0; i<_count; i++) {
+
+		if(!_value[i].IsInt()) {
+
+			return false;
+		}
+
+		_out[i]=_value[i].GetInt();
+	}
+
+	return true;
+}
+
+//!Creates a box from a token list. Internal.
+ldv::rect box_from_list(
+	const int * _values
+) {
+
+	return ldv::rect{_values[0], _values[1], (unsigned int)_values[2], (unsigned int)_values[3]};
+}
+
+//!SAX handler that stops when the array of the named layout begins. Internal.
+struct layout_seeker:
+	public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, layout_seeker> {
+
+	                layout_seeker(std::string_view _name)
+		:name(_name) {
+
+	}
+
+	bool            Default() {return true;}
+
+	bool            StartObject() {
+
+		++depth;
+		return true;
+	}
+
+	bool            EndObject(rapidjson::SizeType) {
+
+		--depth;
+		return true;
+	}
+
+	bool            Key(const char * _key, rapidjson::SizeType _length, bool) {
+
+		if(1==depth) {
+
+			matched=name==std::string_view{_key, _length};
+		}
+
+		return true;
+	}
+
+	bool            StartArray() {
+
+		//Returning false stops the reader right after the bracket.
+		if(1==depth && matched) {
+
+			found=true;
+			return false;
+		}
+
+		++depth;
+		return true;
+	}
+
+	bool            EndArray(rapidjson::SizeType) {
+
+		--depth;
+		return true;
+	}
+
+	std::string_view    name;           //!< Layout to find.
+	int                 depth{0};       //!< Nesting of the current value.
+	bool                matched{false}, //!< The last key of the root object is the name.
+	                    found{false};   //!< The layout array has begun.
+};
+
+//!Creates a rgba from a token list. Internal.
+ldv::rgba_color rgba_from_list(
+	const int * _values
+) {
+
+	return ldv::rgba8(_values[0], _values[1], _values[2], _values[3]);
+}
+
+}
+
 //!Parses the json document.
 
 //!Will if there are malformations in the layout file.
 void view_composer::parse(const rapidjson::Value& _root) {
 
+	LDTOOLS_PROFILE_ZONE("view_composer::parse");
+
 	if(!_root.IsArray()) {
 
 		throw std::runtime_error("root node must be an array");
 	}
 
-	for(const auto& token : _root.GetArray()) {
+	view_token token;
+	for(const auto& value : _root.GetArray()) {
+
+		read_token(value, token);
+		build(token);
+	}
+
+	std::sort(std::begin(data), std::end(data));
+}
+
+//!Mounts a layout of a compiled file.
 
-		uptr_rep ptr;
-		const std::string tipo{token[type_key].GetString()}; //Si no hay tipo vamos a explotar. Correcto.
-		int order=0;
+//!Tokens come checked and typed, so they are built right away. Will throw
+//!if the layout does not exist or if a resource is not mapped.
+void view_composer::parse(
+	const compiled_view_layout& _layout,
+	const std::string& _name
+) {
 
-		if(tipo==box_key) ptr=std::move(create_box(token));
-		else if(tipo==bitmap_key) ptr=std::move(create_bitmap(token));
-		else if(tipo==ttf_key) ptr=std::move(create_ttf(token));
-		else if(tipo==polygon_key) ptr=std::move(create_polygon(token));
-		else if(tipo==external_key) {
+	LDTOOLS_PROFILE_ZONE("view_composer::parse");
 
-			const std::string ref=token[external_reference_key].GetString();
-			if(!external_map.count(ref)) {
-				throw std::runtime_error("Key for '"+ref+"' has not been externally registered before parsing the file.");
-			}
+	const auto range=_layout.find(_name);
+
+	view_token token;
+	for(auto i=range.first; i<range.second; i++) {
+
+		_layout.read(i, token);
+		build(token);
+	}
+
+	std::sort(std::begin(data), std::end(data));
+}
+
+//!Mounts a layout of a json file, streaming it.
+void view_composer::parse_file(
+	const std::string& _path,
+	const std::string& _layout
+) {
+
+	std::unique_ptr<std::FILE, int(*)(std::FILE *)> file{std::fopen(_path.c_str(), "rb"), &std::fclose};
+	if(nullptr==file) {
+
+		throw std::runtime_error("Unable to open view layout file "+_path);
+	}
+
+	std::vector<char> buffer(65536);
+	rapidjson::FileReadStream stream{file.get(), buffer.data(), buffer.size()};
+	parse_stream<rapidjson::kParseDefaultFlags>(stream, _layout);
+}
+
+//!Mounts a layout of a json buffer, streaming it.
+void view_composer::parse_buffer(
+	const char * _buffer,
+	std::size_t _size,
+	const std::string& _layout
+) {
+
+	rapidjson::MemoryStream stream{_buffer, _size};
+	parse_stream<rapidjson::kParseDefaultFlags>(stream, _layout);
+}
+
+//!Mounts a layout of a json buffer, streaming it in situ.
+void view_composer::parse_insitu(
+	char * _buffer,
+	const std::string& _layout
+) {
+
+	rapidjson::InsituStringStream stream{_buffer};
+	parse_stream<rapidjson::kParseInsituFlag>(stream, _layout);
+}
+
+//!Mounts a layout from a json stream. Internal.
+
+//!The SAX reader walks the file until the array of the layout begins, which
+//!skips the layouts before it without building them. From there each token
+//!is read into a small document of its own and built right away, and the
+//!stream is left as soon as the layout ends.
+template<unsigned F, typename S>
+void view_composer::parse_stream(
+	S& _stream,
+	const std::string& _layout
+) {
+
+	LDTOOLS_PROFILE_ZONE("view_composer::parse");
+
+	layout_seeker seeker{_layout};
+	rapidjson::Reader reader;
+	const auto result=reader.Parse<F>(_stream, seeker);
+
+	if(!seeker.found) {
+
+		if(result.IsError()) {
+
+			throw std::runtime_error(std::string{"Unable to parse view layout: "}+rapidjson::GetParseError_En(result.Code())+" at "+std::to_string(result.Offset()));
+		}
+
+		throw std::runtime_error("Unable to locate layout "+_layout+" in view layout");
+	}
+
+	//Tokens are small, so the pool usually does without the heap. It is
+	//cleared for each of them.
+	char pool[4096];
+	rapidjson::MemoryPoolAllocator<> allocator{pool, sizeof(pool)};
+	rapidjson::Document document{&allocator};
+	view_token token;
+
+	rapidjson::SkipWhitespace(_stream);
+	if(']'==_stream.Peek()) {
+
+		_stream.Take();
+	}
+	else while(true) {
+
+		document.template ParseStream<F | rapidjson::kParseStopWhenDoneFlag>(_stream);
+		if(document.HasParseError()) {
+
+			throw std::runtime_error(std::string{"Unable to parse view layout: "}+rapidjson::GetParseError_En(document.GetParseError())+" at "+std::to_string(document.GetErrorOffset()));
+		}
+
+		read_token(document, token);
+		build(token);
+
+		document.SetNull();
+		allocator.Clear();
+
+		rapidjson::SkipWhitespace(_stream);
+		const auto next=_stream.Take();
+		if(']'==next) {
+
+			break;
+		}
+		else if(','!=next) {
+
+			throw std::runtime_error("Unable to parse view layout: missing a comma or ']' after an array element at "+std::to_string(_stream.Tell()));
+		}
+	}
+
+	std::sort(std::begin(data), std::end(data));
+}
+
+//!Reads a json layout entry into a token.
+
+//!Only the string compares on the type and the attribute names are done
+//!here, the rest is shared with compiled layouts.
+void view_composer::read_token(
+	const rapidjson::Value& _value,
+	view_token& _token
+) {
+
+	_token.clear();
+
+	if(!_value.IsObject()) {
+
+		throw std::runtime_error("view entries must be objects");
+	}
+
+	auto optional=[&_value](const char * _key) -> const rapidjson::Value * {
 
-			if(token.HasMember(order_key)) {
-				order=token[order_key].GetInt();
+		auto it=_value.FindMember(_key);
+		return it==_value.MemberEnd() ? nullptr : &it->value;
+	};
+
+	auto member=[&optional](const char * _key) -> const rapidjson::Value& {
+
+		const auto * result=optional(_key);
+		if(nullptr==result) {
+
+			throw std::runtime_error(std::string{"Missing '"}+_key+"' when parsing view");
+		}
+
+		return *result;
+	};
+
+	auto string_of=[](const rapidjson::Value& _node, const char * _key) -> std::string_view {
+
+		if(!_node.IsString()) {
+
+			throw std::runtime_error(std::string{"'"}+_key+"' must be a string when parsing view");
+		}
+
+		return {_node.GetString(), _node.GetStringLength()};
+	};
+
+	auto int_of=[](const rapidjson::Value& _node, const char * _key) {
+
+		if(!_node.IsInt()) {
+
+			throw std::runtime_error(std::string{"'"}+_key+"' must be an integer when parsing view");
+		}
+
+		return _node.GetInt();
+	};
+
+	auto ints=[&member](const char * _key, int * _out, rapidjson::SizeType _count) {
+
+		if(!ints_from_list(member(_key), _out, _count)) {
+
+			throw std::runtime_error(std::string{"'"}+_key+"' needs "+std::to_string(_count)+" integers when parsing view");
+		}
+	};
+
+	auto rgba=[&member, &_token]() {
+
+		if(!ints_from_list(member(rgba_key), _token.rgba, 4)) {
+
+			throw std::runtime_error("Unable to parse rgba value... did you forget to add the alpha?");
+		}
+	};
+
+	const auto type=string_of(member(type_key), type_key);
+
+	if(type==box_key) {
+
+		_token.type=view_token::types::box;
+		ints(location_key, _token.location, 4);
+		rgba();
+	}
+	else if(type==bitmap_key) {
+
+		_token.type=view_token::types::bitmap;
+		_token.resource=string_of(member(texture_key), texture_key);
+		ints(location_key, _token.location, 4);
+		ints(clip_key, _token.clip, 4);
+
+		if(optional(brush_key)) {
+
+			ints(brush_key, _token.brush, 2);
+			_token.set(view_token::has_brush);
+		}
+	}
+	else if(type==ttf_key) {
+
+		_token.type=view_token::types::ttf;
+		_token.resource=string_of(member(font_key), font_key);
+		_token.text=string_of(member(text_key), text_key);
+		ints(location_key, _token.location, 2);
+		rgba();
+
+		if(const auto * ratio=optional(line_height_ratio_key)) {
+
+			if(!ratio->IsNumber()) {
+
+				throw std::runtime_error(std::string{"'"}+line_height_ratio_key+"' must be a number when parsing view");
 			}
 
-			data.push_back(item(external_map[ref], order));
-			continue;
+			_token.ratio=ratio->GetDouble();
+			_token.set(view_token::has_ratio);
+		}
+	}
+	else if(type==polygon_key) {
+
+		_token.type=view_token::types::polygon;
+		rgba();
+
+		const auto fill=string_of(member(polygon_fill_key), polygon_fill_key);
+		if(fill=="line") {
+
+			_token.set(view_token::line_fill);
+		}
+		else if(fill!="fill") {
+
+			throw std::runtime_error("Invalid fill type for polygon");
 		}
-		else if(tipo==screen_key) {
 
-			do_screen(token);
-			continue;
+		const auto& points=member(points_key);
+		if(!points.IsArray()) {
+
+			throw std::runtime_error(std::string{"'"}+points_key+"' must be a list when parsing view");
 		}
-		else if(tipo==definition_key) {
 
-			do_definition(token);
-			continue;
+		for(const auto& point : points.GetArray()) {
+
+			int values[2];
+			if(!ints_from_list(point, values, 2)) {
+
+				throw std::runtime_error(std::string{"'"}+points_key+"' needs pairs of integers when parsing view");
+			}
+
+			_token.points.push_back({values[0], values[1]});
 		}
-		else {
+	}
+	else if(type==external_key) {
+
+		_token.type=view_token::types::external;
+		_token.resource=string_of(member(external_reference_key), external_reference_key);
 
-			throw std::runtime_error(std::string{"Unknown '"}+tipo+"' when parsing view");
+		if(const auto * order=optional(order_key)) {
+
+			_token.order=int_of(*order, order_key);
+			_token.set(view_token::has_order);
 		}
 
-		//Tratamiento de cosas comunes...
-		if(token.HasMember(order_key))  {
+		return;
+	}
+	else if(type==screen_key) {
+
+		_token.type=view_token::types::screen;
+		rgba();
+		return;
+	}
+	else if(type==definition_key) {
+
+		_token.type=view_token::types::definition;
+		_token.resource=string_of(member(definition_key_key), definition_key_key);
+
+		const auto& value=member(definition_key_value);
+		if(value.IsInt()) {
 
-			order=token[order_key].GetInt();
+			_token.int_value=value.GetInt();
+			_token.set(view_token::integer);
 		}
+		else if(value.IsFloat()) {
+
+			_token.float_value=value.GetFloat();
+		}
+		else throw std::runtime_error("invalid data type in view composer for definition. Is the view mounted?");
+
+		return;
+	}
+	else {
+
+		throw std::runtime_error(std::string{"Unknown '"}+std::string{type}+"' when parsing view");
+	}
+
+	//Tratamiento de cosas comunes...
+	if(const auto * order=optional(order_key)) {
+
+		_token.order=int_of(*order, order_key);
+		_token.set(view_token::has_order);
+	}
+
+	if(const auto * alpha=optional(alpha_key)) {
+
+		_token.alpha=int_of(*alpha, alpha_key);
+		_token.set(view_token::has_alpha);
+	}
 
-		//Tratamiento de cosas comunes...
-		if(token.HasMember(alpha_key)) {
+	if(const auto * rotation=optional(rotation_key)) {
 
-			ptr->set_blend(ldv::representation::blends::alpha);
-			ptr->set_alpha((Uint8)token[alpha_key].GetInt());
+		if(!rotation->IsArray() || rotation->Size()!=3 || !ints_from_list(*rotation, _token.rotation, 3)) {
+
+			throw std::runtime_error("Rotate needs three parameters");
 		}
 
-		if(token.HasMember(rotation_key)) {
+		_token.set(view_token::has_rotation);
+	}
+
+	if(const auto * visible=optional(visible_key)) {
 
-			auto values=token[rotation_key].GetArray();
-			if(values.Size()!=3) throw std::runtime_error("Rotate needs three parameters");
+		if(!visible->IsBool()) {
 
-			auto * rrot=static_cast<ldv::representation *>(ptr.get());
-			rrot->set_rotation((int)values[0].GetInt());
-			rrot->set_rotation_center((int)values[1].GetInt(), (int)values[2].GetInt());
+			throw std::runtime_error(std::string{"'"}+visible_key+"' must be a boolean when parsing view");
 		}
 
-		if(token.HasMember(visible_key)) {
+		_token.set(view_token::has_visible);
+		if(visible->GetBool()) {
 
-			ptr->set_visible(token[visible_key].GetBool());
+			_token.set(view_token::visible);
 		}
+	}
 
-		if(token.HasMember(id_key)) {
+	if(const auto * id=optional(id_key)) {
 
-			const std::string id=token[id_key].GetString();
-			if(id_map.count(id)) {
-				throw std::runtime_error(std::string{"Repeated id key '"}+id+"' for view");
+		_token.id=string_of(*id, id_key);
+		_token.set(view_token::has_id);
+	}
+}
+
+//!Adds the representation or definition of a token. Internal.
+void view_composer::build(const view_token& _token) {
+
+	uptr_rep ptr;
+	const int order=_token.has(view_token::has_order) ? _token.order : 0;
+
+	switch(_token.type) {
+
+		case view_token::types::box: ptr=create_box(_token); break;
+		case view_token::types::bitmap: ptr=create_bitmap(_token); break;
+		case view_token::types::ttf: ptr=create_ttf(_token); break;
+		case view_token::types::polygon: ptr=create_polygon(_token); break;
+		case view_token::types::external: {
+
+			auto it=external_map.find(_token.resource);
+			if(it==std::end(external_map)) {
+				throw std::runtime_error("Key for '"+std::string{_token.resource}+"' has not been externally registered before parsing the file.");
 			}
 
-			id_map[id]=ptr.get();
+			data.push_back(item(it->second, order));
+			return;
+		}
+		case view_token::types::screen:
+
+			do_screen(_token);
+			return;
+		case view_token::types::definition:
+
+			do_definition(_token);
+			return;
+	}
+
+	//Tratamiento de cosas comunes...
+	if(_token.has(view_token::has_alpha)) {
+
+		ptr->set_blend(ldv::representation::blends::alpha);
+		ptr->set_alpha((Uint8)_token.alpha);
+	}
+
+	if(_token.has(view_token::has_rotation)) {
+
+		ptr->set_rotation(_token.rotation[0]);
+		ptr->set_rotation_center(_token.rotation[1], _token.rotation[2]);
+	}
+
+	if(_token.has(view_token::has_visible)) {
+
+		ptr->set_visible(_token.has(view_token::visible));
+	}
+
+	if(_token.has(view_token::has_id)) {
+
+		if(id_map.count(_token.id)) {
+			throw std::runtime_error("Repeated id key '"+std::string{_token.id}+"' for view");
 		}
 
-		//Y finalmente insertamos.
-		data.push_back(item(std::move(ptr), order));
+		id_map.emplace(std::string{_token.id}, ptr.get());
 	}
 
-	std::sort(std::begin(data), std::end(data));
+	//Y finalmente insertamos.
+	data.push_back(item(std::move(ptr), order));
 }
 
 //!Registers the given representation with the handle.
@@ -305,158 +782,108 @@ void view_composer::register_as_external(const std::string& clave, ldv::represen
 }
 
 //!Creates a box from a token. Internal.
-view_composer::uptr_rep view_composer::create_box(const rapidjson::Value& token) {
+view_composer::uptr_rep view_composer::create_box(const view_token& _token) {
 
-	auto color=rgba_from_list(token[rgba_key]);
-	uptr_rep res(new ldv::box_representation(box_from_list(token[location_key]), color, ldv::polygon_representation::type::fill));
+	uptr_rep res(new ldv::box_representation(box_from_list(_token.location), rgba_from_list(_token.rgba), ldv::polygon_representation::type::fill));
 	res->set_blend(ldv::representation::blends::alpha);
 	return res;
 }
 
 //!Creates a polygon from a token. Internal.
-view_composer::uptr_rep view_composer::create_polygon(const rapidjson::Value& token) {
-
-	auto color=rgba_from_list(token[rgba_key]);
+view_composer::uptr_rep view_composer::create_polygon(const view_token& _token) {
 
-	ldv::polygon_representation::type t=ldv::polygon_representation::type::fill;
-	const std::string sfill=token[polygon_fill_key].GetString();
-	if(sfill=="fill")		t=ldv::polygon_representation::type::fill;
-	else if(sfill=="line")		t=ldv::polygon_representation::type::line;
-	else throw std::runtime_error("Invalid fill type for polygon");
+	const auto t=_token.has(view_token::line_fill)
+		? ldv::polygon_representation::type::line
+		: ldv::polygon_representation::type::fill;
 
 	std::vector<ldv::point>	vp;
-	for(const auto& l : token[points_key].GetArray()) {
-		vp.push_back({l[0].GetInt(), l[1].GetInt()});
+	vp.reserve(_token.points.size());
+	for(const auto& p : _token.points) {
+		vp.push_back({p.x, p.y});
 	}
 
-	uptr_rep res(new ldv::polygon_representation(vp, color, t));
+	uptr_rep res(new ldv::polygon_representation(vp, rgba_from_list(_token.rgba), t));
 	res->set_blend(ldv::representation::blends::alpha);
 	return res;
 }
 
 //!Creates a bitmap from a token. Internal.
-view_composer::uptr_rep view_composer::create_bitmap(const rapidjson::Value& token) {
+view_composer::uptr_rep view_composer::create_bitmap(const view_token& _token) {
 
-	const std::string texkey=token[texture_key].GetString();
-
-	if(!texture_map.count(texkey)) {
-		throw std::runtime_error(std::string{"Unable to locate texture "}+texkey+" for bitmap");
+	auto it=texture_map.find(_token.resource);
+	if(it==std::end(texture_map)) {
+		throw std::runtime_error("Unable to locate texture "+std::string{_token.resource}+" for bitmap");
 	}
 
 	uptr_rep res(
 		new ldv::bitmap_representation
 		(
-			*texture_map[texkey],
-			box_from_list(token[location_key]),
-			box_from_list(token[clip_key])
+			*it->second,
+			box_from_list(_token.location),
+			box_from_list(_token.clip)
 		)
 	);
 
 	res->set_blend(ldv::representation::blends::alpha);
 
-	if(token.HasMember(brush_key)) {
-
-		const auto& entries=token[brush_key].GetArray();
+	if(_token.has(view_token::has_brush)) {
 
-		static_cast<ldv::bitmap_representation *>(res.get())->set_brush(entries[0].GetInt(), entries[1].GetInt());
+		static_cast<ldv::bitmap_representation *>(res.get())->set_brush(_token.brush[0], _token.brush[1]);
 	}
 
 	return res;
 }
 
 //!Creates a ttf representation from a token. Internal.
-view_composer::uptr_rep view_composer::create_ttf(const rapidjson::Value& token) {
-
-	const std::string fontkey=token[font_key].GetString();
-
-	if(!font_map.count(fontkey)) {
-		throw std::runtime_error(std::string{"Unable to locate font "}+fontkey+" for ttf");
-	}
-
-	double ratio=1.;
-	if(token.HasMember(line_height_ratio_key)) {
+view_composer::uptr_rep view_composer::create_ttf(const view_token& _token) {
 
-		ratio=token[line_height_ratio_key].GetDouble();
+	auto it=font_map.find(_token.resource);
+	if(it==std::end(font_map)) {
+		throw std::runtime_error("Unable to locate font "+std::string{_token.resource}+" for ttf");
 	}
 
+	//The ratio is given to the constructor, so the text is rendered once.
 	uptr_rep res(
 		new ldv::ttf_representation(
-			*font_map[fontkey],
-			rgba_from_list(token[rgba_key]),
-			token[text_key].GetString(),
-			ratio
+			*it->second,
+			rgba_from_list(_token.rgba),
+			std::string{_token.text},
+			_token.has(view_token::has_ratio) ? _token.ratio : 1.
 		)
 	);
 
 	res->set_blend(ldv::representation::blends::alpha);
-
-	if(token.HasMember(text_line_height_ratio_key)) {
-
-		static_cast<ldv::ttf_representation *>(res.get())->set_line_height_ratio(token[text_line_height_ratio_key].GetDouble());
-	}
-
-	auto pos=position_from_list(token[location_key]);
-	res->go_to({pos.x, pos.y});
+	res->go_to({_token.location[0], _token.location[1]});
 	return res;
 }
 
 //!Records screen color fill values. Internal.
-void view_composer::do_screen(const rapidjson::Value& token) {
+void view_composer::do_screen(const view_token& _token) {
 
-	screen_color=rgba_from_list(token[rgba_key]);
+	screen_color=rgba_from_list(_token.rgba);
 	with_screen=true;
 }
 
 //!Records a definition. Internal.
-void view_composer::do_definition(const rapidjson::Value& token) {
+void view_composer::do_definition(const view_token& _token) {
 
-	const std::string clave{token[definition_key_key].GetString()};
+	const std::string clave{_token.resource};
 
 	if(int_definitions.count(clave)) {
 
 		throw std::runtime_error("repeated definition in view composer for "+clave);
 	}
 
-	if(token[definition_key_value].IsInt()) {
-
-		int_definitions[clave]=token[definition_key_value].GetInt();
-	}
-	else if(token[definition_key_value].IsFloat()) {
+	if(_token.has(view_token::integer)) {
 
-		float_definitions[clave]=token[definition_key_value].GetFloat();
+		int_definitions[clave]=_token.int_value;
 	}
-	else throw std::runtime_error("invalid data type in view composer for definition. Is the view mounted?");
-}
-
-//!Creates a box from a token. Internal.
-ldv::rect view_composer::box_from_list(const rapidjson::Value& tok) {
-
-	const auto& values=tok.GetArray();
-	int x=values[0].GetInt(), y=values[1].GetInt(), w=values[2].GetInt(), h=values[3].GetInt();
-	return ldv::rect{x, y, (unsigned int)w, (unsigned int)h};
-}
-
-//!Creates a rgba from a token. Internal.
-ldv::rgba_color view_composer::rgba_from_list(const rapidjson::Value& tok) {
+	else {
 
-	try {
-		const auto& values=tok.GetArray();
-		int r=values[0].GetInt(), g=values[1].GetInt(), b=values[2].GetInt(), a=values[3].GetInt();
-		return ldv::rgba8(r, g, b, a);
-	}
-	catch(std::exception& e) {
-		throw std::runtime_error(std::string("Unable to parse rgba value... did you forget to add the alpha? : ")+e.what());
+		float_definitions[clave]=_token.float_value;
 	}
 }
 
-//!Creates a position box from a token. Internal.
-view_composer::position view_composer::position_from_list(const rapidjson::Value& tok) {
-
-	const auto& values=tok.GetArray();
-	int x=values[0].GetInt(), y=values[1].GetInt();
-	return position{x, y};
-}
-
 //!Clears all view elements.
 
 //!Representations, id maps and external references are cleared. Definitions
@@ -495,7 +922,16 @@ void view_composer::set_text(
 	const std::string& _value
 ) {
 
-	static_cast<ldv::ttf_representation*>(get_by_id(_id))->set_text(_value);
+	auto * rep=static_cast<ldv::ttf_representation*>(get_by_id(_id));
+
+	//Compared with the representation itself, so changes made to it
+	//through get_by_id count too.
+	if(rep->get_text()==_value) {
+
+		return;
+	}
+
+	rep->set_text(_value);
 }
 
 void view_composer::set_text_color(
@@ -503,7 +939,17 @@ void view_composer::set_text_color(
 	const ldv::rgba_color& _value
 ) {
 
-	static_cast<ldv::ttf_representation*>(get_by_id(_id))->set_color(_value);
+	auto * rep=static_cast<ldv::ttf_representation*>(get_by_id(_id));
+
+	const auto current=rep->get_color();
+	if(current.r==_value.r && current.g==_value.g
+		&& current.b==_value.b && current.a==_value.a
+	) {
+
+		return;
+	}
+
+	rep->set_color(_value);
 }
 
 void view_composer::set_visible(
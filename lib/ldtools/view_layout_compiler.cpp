@@ -0,0 +1,196 @@
+#include <ldtools/view_layout_compiler.h>
+#include <ldtools/view_composer.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+using namespace ldtools;
+
+void ldtools::compile_view_layout(
+	const rapidjson::Value& _root,
+	const std::string& _path
+) {
+
+	if(!_root.IsObject()) {
+
+		throw std::runtime_error("root node of a view layout file must be an object");
+	}
+
+	//Strings point into the document while compiling.
+	std::map<std::string_view, std::uint32_t> interned;
+	std::vector<std::string_view> strings;
+
+	auto intern=[&interned, &strings](std::string_view _value) -> std::uint32_t {
+
+		auto it=interned.find(_value);
+		if(it!=std::end(interned)) {
+
+			return it->second;
+		}
+
+		const auto index=static_cast<std::uint32_t>(strings.size());
+		interned.emplace(_value, index);
+		strings.push_back(_value);
+		return index;
+	};
+
+	std::vector<compiled_view_layout_entry> layouts;
+	std::vector<compiled_view_token> tokens;
+	std::vector<compiled_view_point> points;
+	view_token token;
+
+	for(const auto& member : _root.GetObject()) {
+
+		if(!member.value.IsArray()) {
+
+			continue;
+		}
+
+		const std::string_view name{member.name.GetString(), member.name.GetStringLength()};
+		layouts.push_back({intern(name), static_cast<std::uint32_t>(tokens.size()), member.value.Size()});
+
+		for(const auto& value : member.value.GetArray()) {
+
+			view_composer::read_token(value, token);
+
+			compiled_view_token compiled{};
+			compiled.type=static_cast<std::uint8_t>(token.type);
+			compiled.flags=token.flag_set;
+			compiled.order=token.order;
+			compiled.alpha=token.alpha;
+			std::copy(std::begin(token.rotation), std::end(token.rotation), std::begin(compiled.rotation));
+			std::copy(std::begin(token.location), std::end(token.location), std::begin(compiled.location));
+			std::copy(std::begin(token.clip), std::end(token.clip), std::begin(compiled.clip));
+			std::copy(std::begin(token.brush), std::end(token.brush), std::begin(compiled.brush));
+			std::copy(std::begin(token.rgba), std::end(token.rgba), std::begin(compiled.rgba));
+			compiled.int_value=token.int_value;
+			compiled.float_value=token.float_value;
+			compiled.ratio=token.ratio;
+			compiled.id=token.has(view_token::has_id) ? intern(token.id) : compiled_view_token::no_string;
+			compiled.resource=token.resource.data() ? intern(token.resource) : compiled_view_token::no_string;
+			compiled.text=token.text.data() ? intern(token.text) : compiled_view_token::no_string;
+			compiled.first_point=static_cast<std::uint32_t>(points.size());
+			compiled.point_count=static_cast<std::uint32_t>(token.points.size());
+
+			for(const auto& point : token.points) {
+
+				points.push_back({point.x, point.y});
+			}
+
+			tokens.push_back(compiled);
+		}
+	}
+
+	//Layouts are searched by name.
+	std::sort(
+		std::begin(layouts),
+		std::end(layouts),
+		[&strings](const compiled_view_layout_entry& _a, const compiled_view_layout_entry& _b) {
+			return strings[_a.name] < strings[_b.name];
+		}
+	);
+
+	for(std::size_t i=1; i<layouts.size(); i++) {
+
+		if(strings[layouts[i-1].name]==strings[layouts[i].name]) {
+
+			throw std::runtime_error(std::string{"Repeated layout "}+std::string{strings[layouts[i].name]}+" in view layout file");
+		}
+	}
+
+	std::vector<compiled_view_string> string_ranges;
+	std::uint64_t characters_size=0;
+	for(const auto& value : strings) {
+
+		string_ranges.push_back({static_cast<std::uint32_t>(characters_size), static_cast<std::uint32_t>(value.size())});
+		characters_size+=value.size();
+	}
+
+	if(characters_size > std::numeric_limits<std::uint32_t>::max()
+		|| points.size() > std::numeric_limits<std::uint32_t>::max()
+		|| tokens.size() > std::numeric_limits<std::uint32_t>::max()
+	) {
+
+		throw std::runtime_error("view layout file is too large to be compiled");
+	}
+
+	using header_type=compiled_view_layout_header;
+
+	auto align=[](std::uint64_t _offset, std::uint64_t _alignment) {
+
+		return (_offset + _alignment - 1) / _alignment * _alignment;
+	};
+
+	header_type header{};
+	header.magic=header_type::magic_value;
+	header.version=header_type::version_value;
+	header.endianness=header_type::endianness_value;
+	header.token_size=sizeof(compiled_view_token);
+	header.layout_count=layouts.size();
+	header.token_count=tokens.size();
+	header.string_count=strings.size();
+	header.point_count=points.size();
+	header.layouts_offset=align(sizeof(header_type), alignof(compiled_view_layout_entry));
+	header.tokens_offset=align(header.layouts_offset+layouts.size()*sizeof(compiled_view_layout_entry), alignof(compiled_view_token));
+	header.strings_offset=align(header.tokens_offset+tokens.size()*sizeof(compiled_view_token), alignof(compiled_view_string));
+	header.characters_offset=header.strings_offset+string_ranges.size()*sizeof(compiled_view_string);
+	header.characters_size=characters_size;
+	header.points_offset=align(header.characters_offset+characters_size, alignof(compiled_view_point));
+
+	std::vector<char> buffer(header.points_offset+points.size()*sizeof(compiled_view_point), 0);
+	std::memcpy(buffer.data(), &header, sizeof(header_type));
+
+	auto write=[&buffer](std::uint64_t _offset, const void * _data, std::size_t _size) {
+
+		if(_size) {
+
+			std::memcpy(buffer.data()+_offset, _data, _size);
+		}
+	};
+
+	write(header.layouts_offset, layouts.data(), layouts.size()*sizeof(compiled_view_layout_entry));
+	write(header.tokens_offset, tokens.data(), tokens.size()*sizeof(compiled_view_token));
+	write(header.strings_offset, string_ranges.data(), string_ranges.size()*sizeof(compiled_view_string));
+	for(std::size_t i=0; i<strings.size(); i++) {
+
+		write(header.characters_offset+string_ranges[i].offset, strings[i].data(), strings[i].size());
+	}
+	write(header.points_offset, points.data(), points.size()*sizeof(compiled_view_point));
+
+	std::ofstream file(_path, std::ios::binary | std::ios::trunc);
+	if(!file.write(buffer.data(), buffer.size())) {
+
+		throw std::runtime_error(std::string{"unable to write compiled view layout "}+_path);
+	}
+}
+
+void ldtools::compile_view_layout(
+	const std::string& _source,
+	const std::string& _path
+) {
+
+	std::ifstream file(_source, std::ios::binary);
+	if(!file) {
+
+		throw std::runtime_error(std::string{"unable to open view layout file "}+_source);
+	}
+
+	std::stringstream contents;
+	contents<<file.rdbuf();
+
+	rapidjson::Document document;
+	document.Parse(contents.str().c_str());
+	if(document.HasParseError()) {
+
+		throw std::runtime_error(std::string{"unable to parse view layout file "}+_source);
+	}
+
+	compile_view_layout(document, _path);
+}
@@ -0,0 +1,109 @@
+#include "../../include/ldtools/animation_event_bus.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+//Loads the events of events.txt and plays them through the event bus. The
+//walk frames end at 0.01, 0.03 and 0.06 seconds, jumping lasts 0.04.
+
+struct recorder {
+
+	void                        on(const ldtools::animation_event& _event) {events.push_back({_event.entity, _event.event});}
+
+	std::vector<std::pair<std::size_t, std::uint32_t>>  events;
+};
+
+int main(int, char **) {
+
+	try {
+		ldtools::sprite_table sprites{"sprites.txt"};
+		ldtools::animation_table table{sprites, "events.txt"};
+
+		//Names are interned once, in the order they are first read.
+		const auto left=table.get_event_id("step_left"),
+			right=table.get_event_id("step_right"),
+			dust=table.get_event_id("dust"),
+			takeoff=table.get_event_id("takeoff");
+
+		if(4!=table.get_event_count() || 0!=left || 1!=right || 2!=dust || 3!=takeoff || "dust"!=table.get_event_name(dust)) {
+			throw std::runtime_error("failed to assert event ids");
+		}
+
+		const auto& walk=table.get(1);
+		const auto last=walk.get_events(2);
+		if(1!=walk.get_events(0).second-walk.get_events(0).first || walk.get_events(1).first!=walk.get_events(1).second
+			|| 2!=last.second-last.first || right!=last.first[0] || dust!=last.first[1]
+		) {
+			throw std::runtime_error("failed to assert the events of each frame");
+		}
+
+		//A long step crosses frames: their events are queued all the same,
+		//in the order the frames are entered.
+		std::vector<ldtools::animation_player> players{
+			ldtools::animation_player{walk},
+			ldtools::animation_player{table.get(2), ldtools::animation_player::modes::once}
+		};
+
+		ldtools::animation_event_bus bus;
+		recorder all, steps;
+		bus.subscribe(ldtools::animation_event_delegate::bind<recorder, &recorder::on>(all));
+		bus.subscribe(left, ldtools::animation_event_delegate::bind<recorder, &recorder::on>(steps));
+
+		const float deltas[]={0.135f, 0.05f};
+		if(8!=bus.advance(players.data(), deltas, 2) || 8!=bus.get_queue().size() || !all.events.empty()) {
+			throw std::runtime_error("failed to assert queueing the events of a long step");
+		}
+
+		const std::vector<std::pair<std::size_t, std::uint32_t>> expected{
+			{0, left}, {0, right}, {0, dust}, {0, left}, {0, right}, {0, dust}, {0, left},
+			{1, takeoff}
+		};
+
+		if(8!=bus.dispatch() || expected!=all.events || 3!=steps.events.size() || !bus.get_queue().empty()) {
+			throw std::runtime_error("failed to assert dispatching the events of a long step");
+		}
+
+		//Entities are numbered from the given first one.
+		all.events.clear();
+		const float small[]={0.001f, 0.001f}, last_frame[]={0.02f};
+		if(0!=bus.advance(players.data(), small, 2, 10) || 2!=bus.advance(players.data(), last_frame, 1, 10) || 2!=bus.dispatch()
+			|| std::vector<std::pair<std::size_t, std::uint32_t>>({{10, right}, {10, dust}})!=all.events
+		) {
+			throw std::runtime_error("failed to assert entity numbering");
+		}
+
+		//Reloads keep the ids of known events and add the new ones, and
+		//players read the reloaded events.
+		bus.clear();
+		all.events.clear();
+		table.reload("reloaded_events.txt");
+		const auto land=table.get_event_id("land");
+		if(5!=table.get_event_count() || dust!=table.get_event_id("dust") || right!=table.get_event_id("step_right") || 4!=land) {
+			throw std::runtime_error("failed to assert event ids after a reload");
+		}
+
+		ldtools::animation_player again{walk};
+		const float one_pass[]={0.065f};
+		bus.advance(&again, one_pass, 1);
+		bus.dispatch();
+
+		const std::vector<std::pair<std::size_t, std::uint32_t>> reloaded{
+			{0, dust}, {0, land}, {0, right}, {0, dust}
+		};
+
+		if(reloaded!=all.events) {
+			throw std::runtime_error("failed to assert the events of a reloaded animation");
+		}
+
+		std::cout<<"all good"<<std::endl;
+
+		return 0;
+	}
+	catch(std::exception &e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,195 @@
+#include "../../include/ldtools/animation_player.h"
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+//Plays the three frame animation in animations.txt (frames end at 0.01,
+//0.03 and 0.06 seconds). The current frame must be the one
+//animation::index_for_time gives for the time played (wrapped or bounced as
+//the mode says), and the frames entered those crossed on the way.
+
+using modes=ldtools::animation_player::modes;
+
+std::vector<std::size_t> entered(ldtools::animation_player&, float);
+bool close_to(float, float);
+bool matches(const ldtools::animation&, const ldtools::animation_player&, double);
+
+int main(int, char **) {
+
+	try {
+		ldtools::sprite_table sprites{"sprites.txt"};
+		ldtools::animation_table table{sprites, "animations.txt"};
+		const auto& walk=table.get(1);
+
+		//Loop: the first step enters the first frame, a step inside the
+		//frame enters nothing more.
+		ldtools::animation_player loop{walk};
+		if(std::vector<std::size_t>{0}!=entered(loop, 0.005f) || !matches(walk, loop, 0.005)) {
+			throw std::runtime_error("failed to assert entering the first frame");
+		}
+
+		if(!entered(loop, 0.001f).empty() || !matches(walk, loop, 0.006)) {
+			throw std::runtime_error("failed to assert that a small step stays in the frame");
+		}
+
+		if(std::vector<std::size_t>{1}!=entered(loop, 0.009f) || !matches(walk, loop, 0.015)) {
+			throw std::runtime_error("failed to assert entering the next frame");
+		}
+
+		//Crossing the end enters the last frame and wraps to the first.
+		if(std::vector<std::size_t>({2, 0})!=entered(loop, 0.05f) || !matches(walk, loop, 0.065) || !close_to(0.005f, loop.get_time())) {
+			throw std::runtime_error("failed to assert wrapping a loop");
+		}
+
+		//After a reset, a delta of two passes and a bit enters every frame
+		//on the way, the first one included.
+		loop.reset();
+		if(std::vector<std::size_t>({0, 1, 2, 0, 1, 2, 0, 1})!=entered(loop, 0.135f) || !matches(walk, loop, 0.135) || !close_to(0.015f, loop.get_time())) {
+			throw std::runtime_error("failed to assert crossing several loops");
+		}
+
+		//Once: the last frame stays.
+		ldtools::animation_player once{walk, modes::once};
+		if(std::vector<std::size_t>({0, 1, 2})!=entered(once, 0.1f) || !matches(walk, once, 0.1) || !once.is_finished()) {
+			throw std::runtime_error("failed to assert the end of a once animation");
+		}
+
+		if(!entered(once, 0.1f).empty() || !matches(walk, once, 0.2)) {
+			throw std::runtime_error("failed to assert that a finished animation stays");
+		}
+
+		once.reset();
+		if(once.is_finished() || 0!=once.get_index() || std::vector<std::size_t>{0}!=entered(once, 0.001f)) {
+			throw std::runtime_error("failed to assert resetting a once animation");
+		}
+
+		//Ping pong: back and forth without repeating the ends.
+		ldtools::animation_player ping_pong{walk, modes::ping_pong};
+		if(std::vector<std::size_t>({0, 1, 2, 1, 0, 1})!=entered(ping_pong, 0.135f) || !matches(walk, ping_pong, 0.135)) {
+			throw std::runtime_error("failed to assert crossing ping pong ends");
+		}
+
+		//Many small steps of every mode end where index_for_time says.
+		for(auto mode : {modes::loop, modes::ping_pong, modes::once}) {
+
+			ldtools::animation_player player{walk, mode};
+			double time=0.;
+			for(int step=0; step<200; step++) {
+
+				player.advance(0.0037f);
+				time+=0.0037;
+				if(!matches(walk, player, time)) {
+					throw std::runtime_error("failed to assert the frame after "+std::to_string(step+1)+" small steps");
+				}
+			}
+		}
+
+		//Deltas that are not positive and finite do nothing, and huge ones
+		//only walk a few passes.
+		for(auto mode : {modes::loop, modes::ping_pong, modes::once}) {
+
+			ldtools::animation_player player{walk, mode};
+			if(0!=player.advance(-1.f) || 0!=player.advance(std::numeric_limits<float>::infinity()) || 0!=player.advance(std::numeric_limits<float>::quiet_NaN())) {
+				throw std::runtime_error("failed to assert that invalid deltas do nothing");
+			}
+
+			const std::size_t walked=player.advance(1e30f);
+			if(walked > 1+6 * (ldtools::animation_player::max_walked_passes+2) || player.get_index() >= walk.size() || !(player.get_time() >= 0.f)) {
+				throw std::runtime_error("failed to assert that huge deltas are bounded");
+			}
+		}
+
+		//Reloads: the player keeps its time and moves to the frame it
+		//falls in within the new animation.
+		ldtools::animation_player reloaded{walk};
+		entered(reloaded, 0.025f);
+		if(1!=reloaded.get_index() || std::vector<std::size_t>{1}!=table.reload("reloaded.txt") || &walk!=&table.get(1)) {
+			throw std::runtime_error("failed to assert reloading the animation");
+		}
+
+		if(1!=reloaded.get().frame_index || !entered(reloaded, 0.001f).empty() || !matches(walk, reloaded, 0.026)) {
+			throw std::runtime_error("failed to assert that players follow reloaded animations");
+		}
+
+		if(std::vector<std::size_t>({1, 0})!=entered(reloaded, 0.04f) || !matches(walk, reloaded, 0.066)) {
+			throw std::runtime_error("failed to assert playing a reloaded animation");
+		}
+
+		std::cout<<"all good"<<std::endl;
+
+		return 0;
+	}
+	catch(std::exception &e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
+
+std::vector<std::size_t> entered(
+	ldtools::animation_player& _player,
+	float _delta
+) {
+
+	std::vector<std::size_t> result;
+	const auto count=_player.advance(_delta, [&result](std::size_t _index) {result.push_back(_index);});
+
+	if(count!=result.size()) {
+		throw std::runtime_error("failed to assert the number of frames entered");
+	}
+
+	return result;
+}
+
+bool close_to(
+	float _expected,
+	float _value
+) {
+
+	return std::fabs(_expected-_value) < 0.0001f;
+}
+
+//True if the player is in the frame index_for_time gives for the time
+//played, as the mode sees it. Times too close to the end of a frame for
+//float steps to agree on it are taken as good.
+bool matches(
+	const ldtools::animation& _animation,
+	const ldtools::animation_player& _player,
+	double _time
+) {
+
+	const double duration=_animation.get_duration();
+	double time=_time;
+
+	switch(_player.get_mode()) {
+
+		case modes::loop:
+			time=std::fmod(_time, duration);
+		break;
+
+		case modes::once:
+			if(_time >= duration) {
+				return _player.is_finished() && _animation.size()-1==_player.get_index();
+			}
+		break;
+
+		case modes::ping_pong:
+			time=std::fmod(_time, 2. * duration);
+			if(time > duration) {
+				time=2. * duration-time;
+			}
+		break;
+	}
+
+	for(std::size_t i=0; i<_animation.size(); i++) {
+
+		if(std::fabs(_animation.get(i).begin_time-time) < 0.0001 || std::fabs(time) < 0.0001) {
+			return true;
+		}
+	}
+
+	return _animation.index_for_time((float)time)==_player.get_index();
+}
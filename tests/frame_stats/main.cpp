@@ -0,0 +1,107 @@
+#include "../../include/ldtools/frame_stats.h"
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+//Frames last k/1024 seconds, which floats hold exactly, so percentiles can
+//be compared as they are.
+
+int main(int, char **) {
+
+	try {
+		const double unit=1. / 1024.;
+		ldtools::frame_stats stats{100, 90 * unit};
+
+		//An empty window gives zeroes.
+		if(0.!=stats.percentile(50.) || 0.!=stats.mean() || 0!=stats.summary().frames) {
+			throw std::runtime_error("failed to assert that an empty window gives zeroes");
+		}
+
+		//Frames 1 to 100, out of order.
+		for(int i=0; i<100; i++) {
+
+			stats.add(((i * 37) % 100 + 1) * unit);
+		}
+
+		if(100!=stats.size() || 10!=stats.get_hitches()) {
+			throw std::runtime_error("failed to assert size and hitches");
+		}
+
+		//Nearest rank, with percentiles out of range clamped.
+		if(50 * unit!=stats.percentile(50.)
+			|| 95 * unit!=stats.percentile(95.)
+			|| 99 * unit!=stats.percentile(99.)
+			|| 100 * unit!=stats.percentile(100.)
+			|| unit!=stats.percentile(0.)
+			|| unit!=stats.percentile(-5.)
+			|| 100 * unit!=stats.percentile(250.)
+		) {
+			throw std::runtime_error("failed to assert percentiles");
+		}
+
+		const std::string errsentry{"error"};
+		try {
+			stats.percentile(std::nan(""));
+			throw std::runtime_error(errsentry);
+		}
+		catch(std::exception& e) {
+
+			if(e.what() == errsentry) {
+				throw std::runtime_error("failed to assert that NaN percentiles throw");
+			}
+		}
+
+		const auto summary=stats.summary();
+		if(100!=summary.frames
+			|| 10!=summary.hitches
+			|| unit!=summary.min
+			|| 100 * unit!=summary.max
+			|| std::fabs(50.5 * unit-summary.mean) > 1e-9
+			|| stats.percentile(50.)!=summary.p50
+			|| stats.percentile(95.)!=summary.p95
+			|| stats.percentile(99.)!=summary.p99
+		) {
+			throw std::runtime_error("failed to assert the summary");
+		}
+
+		//The window rolls: the oldest frames go.
+		for(int i=0; i<100; i++) {
+
+			stats.add(unit);
+		}
+
+		if(100!=stats.size() || 0!=stats.get_hitches() || 200!=stats.get_total_frames() || 10!=stats.get_total_hitches() || unit!=stats.summary().max) {
+			throw std::runtime_error("failed to assert the rolling window");
+		}
+
+		//Durations that are not finite or negative are ignored, so they
+		//cannot spoil the mean once they leave the window.
+		for(double bad : {std::nan(""), std::numeric_limits<double>::infinity(), -unit, 1e300}) {
+
+			stats.add(bad);
+		}
+
+		if(100!=stats.size() || 200!=stats.get_total_frames() || unit!=stats.mean() || unit!=stats.summary().max) {
+			throw std::runtime_error("failed to assert that invalid durations are ignored");
+		}
+
+		//A single frame is every percentile.
+		ldtools::frame_stats single{10};
+		single.add(3 * unit);
+		const auto one=single.summary();
+		if(3 * unit!=one.p50 || 3 * unit!=one.p99 || 3 * unit!=one.min || 3 * unit!=one.max) {
+			throw std::runtime_error("failed to assert a single frame summary");
+		}
+
+		std::cout<<"all good"<<std::endl;
+
+		return 0;
+	}
+	catch(std::exception &e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
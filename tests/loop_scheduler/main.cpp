@@ -0,0 +1,98 @@
+#include "../../include/ldtools/loop_scheduler.h"
+
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+//Time only moves when told to, in multiples of 1/128 of a second, which
+//doubles and nanoseconds hold exactly.
+
+int main(int, char **) {
+
+	try {
+		const double step=1. / 64.;
+		ldtools::manual_time_source time;
+		ldtools::loop_scheduler scheduler{time, step, 4};
+
+		std::size_t updates=0;
+		double alpha=-1.;
+		auto update=[&updates, step](double _step) {
+
+			if(step!=_step) {
+				throw std::runtime_error("failed to assert the step given to updates");
+			}
+
+			++updates;
+		};
+
+		auto render=[&alpha](double _alpha) {alpha=_alpha;};
+
+		//Two steps and a half.
+		time.advance(5. / 128.);
+		if(2!=scheduler.frame(update, render) || 2!=updates || 0.5!=alpha) {
+			throw std::runtime_error("failed to assert steps and alpha");
+		}
+
+		//Nothing due: the alpha keeps growing.
+		time.advance(1. / 256.);
+		if(0!=scheduler.frame(update, render) || 0.75!=alpha) {
+			throw std::runtime_error("failed to assert a frame without steps");
+		}
+
+		//Ten steps are due but only four run, the rest is dropped and the
+		//fraction kept.
+		time.advance(37. / 256.);
+		if(4!=scheduler.frame(update, render) || 6 * step!=scheduler.get_dropped_time() || 1!=scheduler.get_dropped_frames() || 0.!=alpha) {
+			throw std::runtime_error("failed to assert the step cap");
+		}
+
+		if(6!=scheduler.get_step_count() || 3!=scheduler.get_frame_stats().size()) {
+			throw std::runtime_error("failed to assert step and frame counts");
+		}
+
+		//Time measured elsewhere, invalid values count as nothing.
+		if(0!=scheduler.advance(-1.) || 0!=scheduler.advance(std::numeric_limits<double>::infinity()) || 0!=scheduler.advance(std::numeric_limits<double>::quiet_NaN())) {
+			throw std::runtime_error("failed to assert that invalid times are ignored");
+		}
+
+		if(1!=scheduler.advance(3. / 128.) || 0.5!=scheduler.get_alpha()) {
+			throw std::runtime_error("failed to assert advance");
+		}
+
+		//Reset forgets the accumulated time and what passed meanwhile.
+		time.advance(1.);
+		scheduler.reset();
+		if(0.!=scheduler.get_alpha() || 0!=scheduler.frame(update, render)) {
+			throw std::runtime_error("failed to assert reset");
+		}
+
+		//With a frame limit, waiting moves the time to the end of the frame.
+		scheduler.set_frame_time(1. / 32.);
+		const auto start=time.now();
+		scheduler.frame(update, render);
+		if(std::chrono::duration<double>(time.now()-start).count()!=1. / 32.) {
+			throw std::runtime_error("failed to assert the frame limit");
+		}
+
+		const std::string errsentry{"error"};
+		try {
+			ldtools::loop_scheduler broken{time, 0.};
+			throw std::runtime_error(errsentry);
+		}
+		catch(std::exception& e) {
+
+			if(e.what() == errsentry) {
+				throw std::runtime_error("failed to assert that steps must be positive");
+			}
+		}
+
+		std::cout<<"all good"<<std::endl;
+
+		return 0;
+	}
+	catch(std::exception &e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
@@ -1,6 +1,9 @@
 #include "../../include/ldtools/sprite_table.h"
+#include "../../include/ldtools/sprite_table_compiler.h"
+#include "../../include/ldtools/sprite_quad_cache.h"
 
 #include <iostream>
+#include <iterator>
 #include <stdexcept>
 
 bool check_frame(
@@ -103,6 +106,108 @@ int main(int, char **) {
 			throw std::runtime_error("failed to assert validity of frame 4");
 		}
 
+		//Load the good table in dense storage and compare.
+		ldtools::sprite_table dense{"table.txt", ldtools::sprite_table::storage::dense};
+		if(ldtools::sprite_table::storage::dense!=dense.get_storage() || 5!=dense.size()) {
+			throw std::runtime_error("failed to assert size after loading dense table");
+		}
+
+		std::size_t expected_index=0;
+		for(const auto& pair : dense) {
+
+			const auto& f=table.get(pair.first);
+			if(expected_index++!=pair.first || !check_frame(pair.second, f.box.origin.x, f.box.origin.y, f.box.w, f.box.h, f.disp_x, f.disp_y)) {
+				throw std::runtime_error("failed to assert validity of dense frames");
+			}
+		}
+
+		if(dense.exists(5) || dense.exists(300) || 1!=dense.get(4).flags) {
+			throw std::runtime_error("failed to assert dense indexes and flags");
+		}
+
+		//Iterators are bidirectional and entries outlive them.
+		for(const auto * storage : {&table, &dense}) {
+
+			auto it=std::begin(*storage);
+			const auto& first=*it++;
+			const auto& second=*it++;
+			if(0!=first.first || 1!=second.first || 4!=std::prev(std::end(*storage))->first || 4!=std::make_reverse_iterator(std::end(*storage))->first) {
+				throw std::runtime_error("failed to assert iterator entries and decrements");
+			}
+		}
+
+		//Compile the good table and map it back.
+		ldtools::compile_sprite_table(table, "table.bin");
+		ldtools::sprite_table compiled{};
+		compiled.load_compiled("table.bin");
+
+		if(ldtools::sprite_table::storage::compiled!=compiled.get_storage() || 5!=compiled.size()) {
+			throw std::runtime_error("failed to assert size after loading compiled table");
+		}
+
+		for(const auto& pair : table) {
+
+			if(!compiled.exists(pair.first) || !check_frame(compiled.get(pair.first), pair.second.box.origin.x, pair.second.box.origin.y, pair.second.box.w, pair.second.box.h, pair.second.disp_x, pair.second.disp_y)) {
+				throw std::runtime_error("failed to assert validity of compiled frames");
+			}
+		}
+
+		if(compiled.exists(5) || 1!=compiled.get(4).flags) {
+			throw std::runtime_error("failed to assert compiled indexes and flags");
+		}
+
+		//Compiled tables are only walked as const.
+		const auto& const_compiled=compiled;
+		if(4!=std::prev(std::end(const_compiled))->first || 5!=std::distance(std::begin(const_compiled), std::end(const_compiled))) {
+			throw std::runtime_error("failed to assert compiled iterators");
+		}
+
+		try {
+			compiled.begin();
+			throw std::runtime_error(errsentry);
+		}
+		catch(std::exception& e) {
+
+			if(e.what() == errsentry) {
+
+				throw std::runtime_error("failed to assert that compiled tables cannot be walked as non-const");
+			}
+		}
+
+		//Text files are not compiled tables.
+		try {
+			compiled.load_compiled("table.txt");
+			throw std::runtime_error(errsentry);
+		}
+		catch(std::exception& e) {
+
+			if(e.what() == errsentry) {
+
+				throw std::runtime_error("failed to assert that text tables cannot be loaded as compiled");
+			}
+
+			if(0!=compiled.size()) {
+
+				throw std::runtime_error("failed to assert that the table is empty after an invalid compiled load");
+			}
+		}
+
+		//Quads: frame 4 is flipped horizontally, so left and right swap.
+		ldtools::sprite_quad_cache quads(table, 256, 256);
+		if(table.size()!=quads.size() || quads.exists(5)) {
+			throw std::runtime_error("failed to assert quad cache size");
+		}
+
+		const std::size_t slot=quads.slot(4);
+		const float * uv=quads.get_uvs().data()+slot*8;
+		if(52.f/256.f!=uv[0] || 26.f/256.f!=uv[1] || 25.f/256.f!=uv[2] || 54.f/256.f!=uv[5]) {
+			throw std::runtime_error("failed to assert flipped quad coordinates");
+		}
+
+		if(30!=quads.get_offsets_y()[slot] || 27!=quads.get_widths()[slot]) {
+			throw std::runtime_error("failed to assert quad offsets and extents");
+		}
+
 		//Finally test the iterator change the values...
 		for(auto& pair : table) {
 
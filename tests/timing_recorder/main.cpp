@@ -0,0 +1,85 @@
+#include "../../include/ldtools/timing_replay.h"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+//Records a few frames of awkward lengths, saves them and checks that they
+//are read and replayed exactly.
+
+int main(int, char **) {
+
+	try {
+		const std::string errsentry{"error"};
+
+		ldtools::manual_time_source time;
+		ldtools::timing_recorder recorder{time};
+
+		for(auto delta : {1. / 3., 1. / 60., 1e-7, 0., 2.5}) {
+
+			time.advance(delta);
+			recorder.frame();
+		}
+
+		if(5!=recorder.get_deltas().size() || 0.!=recorder.get_deltas()[3]) {
+			throw std::runtime_error("failed to assert the recorded frames");
+		}
+
+		//Saving and loading gives back the same values, bit by bit.
+		recorder.save("timings.txt");
+		if(recorder.get_deltas()!=ldtools::timing_recorder::load("timings.txt")) {
+			throw std::runtime_error("failed to assert that saved timings load exactly");
+		}
+
+		//Replays play every frame, in order.
+		ldtools::recorded_time_source recorded{"timings.txt"};
+		ldtools::timing_replay replay{recorded};
+
+		std::vector<ldtools::tdelta> played;
+		const auto frames=replay.run([&played](ldtools::tdelta _delta) {played.push_back(_delta);});
+		if(5!=frames || recorder.get_deltas()!=played || 5!=replay.get_costs().size() || recorded.next_frame()) {
+			throw std::runtime_error("failed to assert the replayed frames");
+		}
+
+		//Missing files and files with something else throw.
+		try {
+			ldtools::timing_recorder::load("no_file");
+			throw std::runtime_error(errsentry);
+		}
+		catch(std::exception& e) {
+
+			if(e.what() == errsentry) {
+				throw std::runtime_error("failed to assert that missing recordings cannot be loaded");
+			}
+		}
+
+		for(const std::string contents : {"0x1p-4\nframe\n", "0x1p-4 12\n", "0x1p-4\n1e999\n"}) {
+
+			{
+				std::ofstream file("broken_timings.txt");
+				file<<contents;
+			}
+
+			try {
+				ldtools::timing_recorder::load("broken_timings.txt");
+				throw std::runtime_error(errsentry);
+			}
+			catch(std::exception& e) {
+
+				if(e.what() == errsentry) {
+					throw std::runtime_error("failed to assert that broken recordings cannot be loaded");
+				}
+			}
+		}
+
+		std::cout<<"all good"<<std::endl;
+
+		return 0;
+	}
+	catch(std::exception &e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,198 @@
+#include "../../include/ldtools/view_composer.h"
+#include "../../include/ldtools/view_layout_compiler.h"
+#include "../../include/ldtools/compiled_view_layout.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+//Compiles layouts.json and checks that every compiled token reads the same
+//as the json one. Tokens are compared rather than built, so no textures,
+//fonts or screens are needed. The streamed json readers mount "settings",
+//which only has definitions, skipping the layouts before it.
+
+bool same_token(const ldtools::view_token&, const ldtools::view_token&);
+void must_throw(void (*)(), const std::string&);
+
+int main(int, char **) {
+
+	try {
+		std::ifstream file("layouts.json");
+		std::stringstream contents;
+		contents<<file.rdbuf();
+		const std::string json=contents.str();
+
+		rapidjson::Document document;
+		document.Parse(json.c_str());
+		if(document.HasParseError()) {
+			throw std::runtime_error("failed to read layouts.json");
+		}
+
+		ldtools::compile_view_layout("layouts.json", "layouts.bin");
+		ldtools::compiled_view_layout layout{"layouts.bin"};
+
+		//Only arrays are layouts.
+		if(3!=layout.size() || !layout.has_layout("menu") || !layout.has_layout("options") || !layout.has_layout("settings") || layout.has_layout("version") || layout.has_layout("men")) {
+			throw std::runtime_error("failed to assert compiled layout names");
+		}
+
+		for(const char * name : {"menu", "options", "settings"}) {
+
+			const auto& entries=document[name];
+			const auto range=layout.find(name);
+			if(entries.Size()!=range.second-range.first) {
+				throw std::runtime_error(std::string{"failed to assert the token count of "}+name);
+			}
+
+			ldtools::view_token from_json, from_compiled;
+			for(rapidjson::SizeType i=0; i<entries.Size(); i++) {
+
+				ldtools::view_composer::read_token(entries[i], from_json);
+				layout.read(range.first+i, from_compiled);
+				if(!same_token(from_json, from_compiled)) {
+					throw std::runtime_error(std::string{"failed to assert compiled token "}+std::to_string(i)+" of "+name);
+				}
+			}
+		}
+
+		//Spot check a few values, so that the comparison is not vacuous.
+		ldtools::view_token token;
+		layout.read(layout.find("menu").first+3, token);
+		if(ldtools::view_token::types::box!=token.type || "background"!=token.id || 800!=token.location[2] || 128!=token.alpha || !token.has(ldtools::view_token::has_visible) || token.has(ldtools::view_token::visible)) {
+			throw std::runtime_error("failed to assert compiled box values");
+		}
+
+		layout.read(layout.find("menu").first+6, token);
+		if(3!=token.points.size() || 20!=token.points[2].x || !token.has(ldtools::view_token::line_fill)) {
+			throw std::runtime_error("failed to assert compiled polygon values");
+		}
+
+		//Strings are stored once.
+		ldtools::view_token other;
+		layout.read(layout.find("options").first, other);
+		layout.read(layout.find("menu").first+3, token);
+		if(other.id.data()!=token.id.data()) {
+			throw std::runtime_error("failed to assert that compiled strings are shared");
+		}
+
+		must_throw([]() {ldtools::compiled_view_layout{"layouts.bin"}.find("nothing");}, "failed to assert that missing layouts cannot be found");
+		must_throw([]() {ldtools::compiled_view_layout{"no_file"};}, "failed to assert that missing files cannot be loaded");
+		must_throw([]() {ldtools::compiled_view_layout{"layouts.json"};}, "failed to assert that json files cannot be loaded as compiled");
+
+		//A good header with nothing behind it.
+		{
+			std::ifstream source("layouts.bin", std::ios::binary);
+			std::ofstream target("short_layouts.bin", std::ios::binary);
+			std::copy_n(std::istreambuf_iterator<char>{source}, sizeof(ldtools::compiled_view_layout_header), std::ostreambuf_iterator<char>{target});
+		}
+
+		must_throw([]() {ldtools::compiled_view_layout{"short_layouts.bin"};}, "failed to assert that truncated files cannot be loaded");
+
+		//Malformed entries do not compile.
+		must_throw([]() {
+
+			rapidjson::Document broken;
+			broken.Parse(R"({"menu":[{"type":"box", "location":[0, 0, 1], "rgba":[1, 1, 1, 1]}]})");
+			ldtools::compile_view_layout(broken, "broken.bin");
+		}, "failed to assert that malformed layouts cannot be compiled");
+
+		//Streamed layouts: the ones before are skipped without building
+		//anything, or the unmapped texture and font in them would throw.
+		for(int reader=0; reader<3; reader++) {
+
+			ldtools::view_composer composer;
+			std::string buffer{json};
+			switch(reader) {
+				case 0: composer.parse_file("layouts.json", "settings"); break;
+				case 1: composer.parse_buffer(buffer.data(), buffer.size(), "settings"); break;
+				case 2: composer.parse_insitu(&buffer[0], "settings"); break;
+			}
+
+			if(0!=composer.size() || 3!=composer.get_int("speed") || 1.5f!=composer.get_float("ratio")) {
+				throw std::runtime_error("failed to assert streamed definitions with reader "+std::to_string(reader));
+			}
+		}
+
+		must_throw([]() {ldtools::view_composer{}.parse_file("no_file", "settings");}, "failed to assert that missing json files cannot be streamed");
+		must_throw([]() {ldtools::view_composer{}.parse_file("layouts.json", "version");}, "failed to assert that values other than arrays are not layouts");
+		must_throw([]() {ldtools::view_composer{}.parse_file("layouts.json", "nothing");}, "failed to assert that missing layouts cannot be streamed");
+		must_throw([]() {ldtools::view_composer{}.parse_file("layouts.json", "menu");}, "failed to assert that unmapped resources throw when streamed");
+
+		for(const std::string broken : {
+			R"({"settings":[{"type":"define", "key":"a", "value":1} {"type":"define", "key":"b", "value":2}]})",
+			R"({"skipped":[ oops ], "settings":[]})",
+			R"({"settings":[{"type":"define", "key":"a", "value":1},)",
+			R"({"settings":[{"type":"define", "key":"a"}]})"
+		}) {
+
+			try {
+				ldtools::view_composer{}.parse_buffer(broken.data(), broken.size(), "settings");
+				throw std::runtime_error("error");
+			}
+			catch(std::exception& e) {
+
+				if(std::string{"error"}==e.what()) {
+					throw std::runtime_error("failed to assert that malformed json cannot be streamed: "+broken);
+				}
+			}
+		}
+
+		std::cout<<"all good"<<std::endl;
+
+		return 0;
+	}
+	catch(std::exception &e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
+
+bool same_token(
+	const ldtools::view_token& _a,
+	const ldtools::view_token& _b
+) {
+
+	auto same_points=[](const ldtools::view_token::point& _pa, const ldtools::view_token::point& _pb) {
+		return _pa.x==_pb.x && _pa.y==_pb.y;
+	};
+
+	return _a.type==_b.type
+		&& _a.flag_set==_b.flag_set
+		&& _a.order==_b.order
+		&& _a.alpha==_b.alpha
+		&& std::equal(std::begin(_a.rotation), std::end(_a.rotation), std::begin(_b.rotation))
+		&& std::equal(std::begin(_a.location), std::end(_a.location), std::begin(_b.location))
+		&& std::equal(std::begin(_a.clip), std::end(_a.clip), std::begin(_b.clip))
+		&& std::equal(std::begin(_a.brush), std::end(_a.brush), std::begin(_b.brush))
+		&& std::equal(std::begin(_a.rgba), std::end(_a.rgba), std::begin(_b.rgba))
+		&& _a.int_value==_b.int_value
+		&& _a.float_value==_b.float_value
+		&& _a.ratio==_b.ratio
+		&& _a.id==_b.id
+		&& _a.resource==_b.resource
+		&& _a.text==_b.text
+		&& std::equal(std::begin(_a.points), std::end(_a.points), std::begin(_b.points), std::end(_b.points), same_points);
+}
+
+void must_throw(
+	void (*_call)(),
+	const std::string& _failure
+) {
+
+	const std::string errsentry{"error"};
+
+	try {
+		_call();
+		throw std::runtime_error(errsentry);
+	}
+	catch(std::exception& e) {
+
+		if(e.what() == errsentry) {
+			throw std::runtime_error(_failure);
+		}
+	}
+}
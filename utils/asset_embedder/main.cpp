@@ -0,0 +1,55 @@
+#include <ldtools/asset_embedder.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+//Writes sprite and animation tables as C++ headers with constexpr data, so
+//shipped builds can create the tables without reading files. Used by the
+//CMake helpers in cmake/ldtools_embed.cmake.
+
+int main(int argc, char ** argv) {
+
+	const std::string mode{argc > 1 ? argv[1] : ""};
+
+	if(!(("sprites"==mode && 5==argc) || ("animations"==mode && 6==argc))) {
+
+		std::cerr<<"use: "<<argv[0]<<" sprites sprite_table name header"<<std::endl
+			<<"     "<<argv[0]<<" animations sprite_table animation_table name header"<<std::endl;
+		return 1;
+	}
+
+	try {
+
+		//Written in memory first, so a failure leaves no half header.
+		std::stringstream out;
+		const ldtools::sprite_table sprites{argv[2]};
+		std::string path;
+
+		if("sprites"==mode) {
+
+			ldtools::embed_sprite_table(sprites, argv[3], out);
+			path=argv[4];
+		}
+		else {
+
+			const ldtools::animation_table animations{sprites, argv[3]};
+			ldtools::embed_animation_table(animations, argv[4], out);
+			path=argv[5];
+		}
+
+		std::ofstream file(path, std::ios::trunc);
+		if(!(file<<out.rdbuf())) {
+
+			throw std::runtime_error("unable to write "+path);
+		}
+
+		return 0;
+	}
+	catch(std::exception &e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,102 @@
+#include <ldtools/atlas_packer.h>
+
+#include <SDL2/SDL_image.h>
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+//Repacks a sprite sheet into atlas pages. Writes the pages as
+//prefix_N.png, the rewritten sprite table as prefix.txt and the page of
+//each frame as prefix.pages.txt.
+
+int main(int argc, char ** argv) {
+
+	if(argc < 4) {
+
+		std::cerr<<"use: "<<argv[0]<<" table sheet prefix [-p padding] [-k] [WxH]..."<<std::endl;
+		std::cerr<<"\t-k keeps duplicated frames, WxH adds a page size to try (1024x1024 by default)"<<std::endl;
+		return 1;
+	}
+
+	try {
+
+		ldtools::atlas_options options;
+		options.page_sizes.clear();
+
+		for(int i=4; i<argc; i++) {
+
+			const std::string arg{argv[i]};
+			if("-p"==arg && i+1 < argc) {
+
+				options.padding=std::stoul(argv[++i]);
+			}
+			else if("-k"==arg) {
+
+				options.deduplicate=false;
+			}
+			else {
+
+				const auto x=arg.find('x');
+				if(std::string::npos==x) {
+
+					throw std::runtime_error("bad page size "+arg);
+				}
+
+				options.page_sizes.push_back({(unsigned)std::stoul(arg.substr(0, x)), (unsigned)std::stoul(arg.substr(x+1))});
+			}
+		}
+
+		if(!options.page_sizes.size()) {
+
+			options.page_sizes.push_back({1024, 1024});
+		}
+
+		const ldtools::sprite_table table{argv[1]};
+		ldtools::atlas_surface sheet{IMG_Load(argv[2]), SDL_FreeSurface};
+		if(!sheet) {
+
+			throw std::runtime_error(std::string{"unable to load "}+argv[2]+": "+IMG_GetError());
+		}
+
+		const auto result=ldtools::atlas_packer{options}.pack(table, sheet.get());
+		const std::string prefix{argv[3]};
+
+		for(std::size_t i=0; i<result.pages.size(); i++) {
+
+			const std::string path=prefix+"_"+std::to_string(i)+".png";
+			if(IMG_SavePNG(result.pages[i].get(), path.c_str())) {
+
+				throw std::runtime_error("unable to save "+path+": "+IMG_GetError());
+			}
+		}
+
+		std::ofstream table_file(prefix+".txt"), pages_file(prefix+".pages.txt");
+		table_file<<"# X\tY\tW\tH\tDESPX\tDESPY\tFLAGS"<<std::endl;
+		pages_file<<"# INDEX\tPAGE"<<std::endl;
+
+		for(const auto& entry : result.layout.table) {
+
+			const auto& f=entry.second;
+			table_file<<entry.first<<"\t"<<f.box.origin.x<<"\t"<<f.box.origin.y<<"\t"<<f.box.w<<"\t"<<f.box.h<<"\t"<<f.disp_x<<"\t"<<f.disp_y<<"\t"<<f.flags<<"\n";
+
+			if(result.layout.pages.count(entry.first)) {
+
+				pages_file<<entry.first<<"\t"<<result.layout.pages.at(entry.first)<<"\n";
+			}
+		}
+
+		const auto& layout=result.layout;
+		std::cout<<layout.page_count<<" page(s) of "<<layout.page_size.w<<"x"<<layout.page_size.h
+			<<", "<<layout.regions<<" regions, "<<layout.duplicates<<" duplicated frames"<<std::endl
+			<<"source "<<layout.source_bytes<<" bytes, atlas "<<layout.atlas_bytes<<" bytes, saved "<<layout.saved_bytes()<<" bytes"<<std::endl;
+
+		return 0;
+	}
+	catch(std::exception &e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
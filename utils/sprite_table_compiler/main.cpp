@@ -0,0 +1,27 @@
+#include <ldtools/sprite_table_compiler.h>
+
+#include <iostream>
+#include <stdexcept>
+
+//Converts sprite table text files to the compiled format that can be mapped
+//into memory by sprite_table::load_compiled.
+
+int main(int argc, char ** argv) {
+
+	if(3!=argc) {
+
+		std::cerr<<"use: "<<argv[0]<<" text_table compiled_table"<<std::endl;
+		return 1;
+	}
+
+	try {
+
+		ldtools::compile_sprite_table(argv[1], argv[2]);
+		return 0;
+	}
+	catch(std::exception &e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}
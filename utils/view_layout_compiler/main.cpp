@@ -0,0 +1,27 @@
+#include <ldtools/view_layout_compiler.h>
+
+#include <iostream>
+#include <stdexcept>
+
+//Converts view layout json files to the compiled format that can be mapped
+//into memory by compiled_view_layout and mounted by view_composer::parse.
+
+int main(int argc, char ** argv) {
+
+	if(3!=argc) {
+
+		std::cerr<<"use: "<<argv[0]<<" json_layout compiled_layout"<<std::endl;
+		return 1;
+	}
+
+	try {
+
+		ldtools::compile_view_layout(argv[1], argv[2]);
+		return 0;
+	}
+	catch(std::exception &e) {
+
+		std::cerr<<"error: "<<e.what()<<std::endl;
+		return 1;
+	}
+}